@@ -0,0 +1,180 @@
+/**
+ * MIT License
+ * Copyright (c) [2022] [Jefferson Zhai]
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef TIME_MODEL_CALENDAR_H
+#define TIME_MODEL_CALENDAR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file time_model_calendar.h
+ * @brief Conversions between the Time model states and civil dates and times
+ * @version 0.1
+ * 
+ * @details The TAI time of the Time model counts the seconds since the epoch 2000-01-01T00:00:00 TAI,
+ * see Section 5.1.1.1. UTC is TAI - TAI-UTC Delta, counted here as the seconds since 2000-01-01T00:00:00 UTC,
+ * and the local time is UTC + Time Zone Offset * 15 minutes. The dates use the proleptic Gregorian calendar,
+ * computed with days-from-civil arithmetic rather than loops over the years and months, and are valid for the
+ * years 1 to 40000, which covers the whole TAI time range.
+ * 
+ */
+
+/** Number of seconds in a Time Zone Offset step, see Section 5.1.1.4 */
+#define TIME_ZONE_OFFSET_STEP_SECONDS (15 * 60)
+
+/** TAI-UTC Delta at the TAI epoch, 2000-01-01 */
+#define TAI_UTC_DELTA_AT_EPOCH (32)
+
+/** Civil date and time */
+typedef struct {
+    int32_t year;
+    uint8_t month; //1 to 12
+    uint8_t day; //1 to 31
+    uint8_t hour; //0 to 23
+    uint8_t minute; //0 to 59
+    uint8_t second; //0 to 59, or 60 during a leap second
+    uint8_t weekday; //0 to 6, from Sunday
+} time_model_civil_t;
+
+/**
+ * Counts the days from 2000-01-01 to a date
+ * 
+ * @param[in]   year    Year, 1 to 40000
+ * @param[in]   month   Month, 1 to 12
+ * @param[in]   day     Day of the month, 1 to 31
+ * 
+ * @return Number of days since 2000-01-01, negative before it
+ */
+int32_t time_model_days_from_civil(int32_t year, uint32_t month, uint32_t day);
+
+/**
+ * Gets the date a number of days after 2000-01-01, leaving the time of the day untouched
+ * 
+ * @param[in]   days        Number of days since 2000-01-01
+ * @param[out]  p_civil     Date, with its weekday
+ */
+void time_model_civil_from_days(int32_t days, time_model_civil_t * p_civil);
+
+/**
+ * Converts a TAI time to UTC
+ * 
+ * @param[in]   tai_seconds     TAI time
+ * @param[in]   tai_utc_delta   TAI-UTC Delta current at that time
+ * 
+ * @return Seconds since 2000-01-01T00:00:00 UTC
+ */
+static inline int64_t time_model_tai_to_utc(uint64_t tai_seconds, int32_t tai_utc_delta) {
+    return (int64_t) tai_seconds - tai_utc_delta;
+}
+
+/**
+ * Converts a TAI time to local time
+ * 
+ * @param[in]   tai_seconds         TAI time
+ * @param[in]   tai_utc_delta       TAI-UTC Delta current at that time
+ * @param[in]   time_zone_offset    Time Zone Offset current at that time, in 15 minute steps
+ * 
+ * @return Local seconds since 2000-01-01T00:00:00
+ */
+static inline int64_t time_model_tai_to_local(uint64_t tai_seconds, int32_t tai_utc_delta, int16_t time_zone_offset) {
+    return (int64_t) tai_seconds - tai_utc_delta + (int64_t) time_zone_offset * TIME_ZONE_OFFSET_STEP_SECONDS;
+}
+
+/**
+ * Converts a TAI time to a civil date and time. Use a time_zone_offset of 0 for UTC
+ * 
+ * @note 23:59:60 can only be told apart from the following 00:00:00 by the TAI-UTC Delta,
+ * which does not change until the end of the leap second, so it is reported as 00:00:00 here.
+ * See time_model_tai_to_civil_leap() for conversions that know about leap seconds.
+ * 
+ * @param[in]   tai_seconds         TAI time
+ * @param[in]   tai_utc_delta       TAI-UTC Delta current at that time
+ * @param[in]   time_zone_offset    Time Zone Offset current at that time, in 15 minute steps
+ * @param[out]  p_civil             Civil date and time
+ */
+void time_model_tai_to_civil(uint64_t tai_seconds, int32_t tai_utc_delta, int16_t time_zone_offset,
+                             time_model_civil_t * p_civil);
+
+/**
+ * Converts a civil date and time to a TAI time, the inverse of time_model_tai_to_civil(). A second
+ * of 60 gives the TAI time of the leap second when the TAI-UTC Delta before it is given
+ * 
+ * @param[in]   p_civil             Civil date and time, the weekday is ignored
+ * @param[in]   tai_utc_delta       TAI-UTC Delta current at that time
+ * @param[in]   time_zone_offset    Time Zone Offset current at that time, in 15 minute steps
+ * 
+ * @return TAI time, or TAI_TIME_UNKNOWN if it is before the TAI epoch
+ */
+uint64_t time_model_civil_to_tai(const time_model_civil_t * p_civil, int32_t tai_utc_delta, int16_t time_zone_offset);
+
+/**
+ * Looks the TAI-UTC Delta up in the table of the leap seconds known at the time of writing, for when
+ * the TAI-UTC Delta state is unknown
+ * 
+ * @param[in]   tai_seconds     TAI time
+ * 
+ * @return TAI-UTC Delta current at that time
+ */
+int32_t time_model_leap_tai_utc_delta_get(uint64_t tai_seconds);
+
+/**
+ * Converts a TAI time to a civil date and time using the table of leap seconds instead of a
+ * TAI-UTC Delta, reporting the leap seconds themselves as 23:59:60 UTC
+ * 
+ * @param[in]   tai_seconds         TAI time
+ * @param[in]   time_zone_offset    Time Zone Offset current at that time, in 15 minute steps
+ * @param[out]  p_civil             Civil date and time
+ */
+void time_model_tai_to_civil_leap(uint64_t tai_seconds, int16_t time_zone_offset, time_model_civil_t * p_civil);
+
+/**
+ * Converts an array of TAI times to local times, see time_model_tai_to_local()
+ * 
+ * @param[in]   p_tai_seconds       TAI times
+ * @param[out]  p_local_seconds     Local seconds since 2000-01-01T00:00:00
+ * @param[in]   count               Number of times to convert
+ * @param[in]   tai_utc_delta       TAI-UTC Delta current at these times
+ * @param[in]   time_zone_offset    Time Zone Offset current at these times, in 15 minute steps
+ */
+void time_model_tai_to_local_batch(const uint64_t * p_tai_seconds, int64_t * p_local_seconds, size_t count,
+                                   int32_t tai_utc_delta, int16_t time_zone_offset);
+
+/**
+ * Converts an array of TAI times to civil dates and times of the day. The results are kept in separate
+ * arrays, and the loop has no branches, so that it can be vectorized by the compiler
+ * 
+ * @param[in]   p_tai_seconds       TAI times
+ * @param[in]   count               Number of times to convert
+ * @param[in]   tai_utc_delta       TAI-UTC Delta current at these times
+ * @param[in]   time_zone_offset    Time Zone Offset current at these times, in 15 minute steps
+ * @param[out]  p_year              Years
+ * @param[out]  p_month             Months, 1 to 12
+ * @param[out]  p_day               Days of the month, 1 to 31
+ * @param[out]  p_second_of_day     Seconds since the start of the day, 0 to 86399
+ */
+void time_model_tai_to_civil_batch(const uint64_t * p_tai_seconds, size_t count,
+                                   int32_t tai_utc_delta, int16_t time_zone_offset,
+                                   int32_t * p_year, uint8_t * p_month, uint8_t * p_day,
+                                   uint32_t * p_second_of_day);
+
+#endif
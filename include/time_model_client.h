@@ -40,16 +40,115 @@
  * Specifications https://www.bluetooth.com/specifications/specs/mesh-model-1-0-1/ to
  * the best of my ability
  * 
- * Note for this version of the time client, only Get Time and Time Status are supported,
- * as since the other messages are optional as long as it support a given set of messages.
- * 
- * Implementing the other messages should be fairly trivial however.
+ * All the Time, Time Zone, TAI-UTC Delta and Time Role messages are supported. The Get and Set
+ * messages can be sent as acknowledged transactions, which retransmit until the corresponding
+ * Status is received, and the Set messages also without a transaction. Either way, the received
+ * Status messages are decoded and given to their own callback.
  * 
  */
 
 /** Time Client model ID according Section 7.3 */
 #define TIME_CLIENT_MODEL_ID 0x1202
 
+/**
+ * @details Number of Time Get requests to unicast addresses that can be queued per client instance, 0 to disable
+ * the request queue
+ *
+ * The acknowledged time_client_time_get() can only have one transaction in flight per model. Queued requests
+ * are instead sent as unacknowledged Time Get messages to their own destination, up to max_in_flight at once,
+ * and each of them ends with its own callback when the Time Status of its destination is received or when
+ * it times out. This lets e.g. a gateway poll a large number of nodes without waiting for each of them in turn.
+ *
+ * The requests are sent with the application key and TTL of the publication of the model, which must have an
+ * application key set, while its publish address is left as it is.
+ */
+#ifndef TIME_CLIENT_REQUEST_QUEUE_SIZE
+#define TIME_CLIENT_REQUEST_QUEUE_SIZE 0
+#endif
+
+/** @details Maximum number of queued requests in flight at once, and the default of time_client_settings_t::max_in_flight */
+#ifndef TIME_CLIENT_MAX_IN_FLIGHT
+#define TIME_CLIENT_MAX_IN_FLIGHT 4
+#endif
+
+/** @details Delay in microseconds before retrying to send a queued request when the mesh stack is out of buffers */
+#ifndef TIME_CLIENT_REQUEST_RETRY_DELAY_US
+#define TIME_CLIENT_REQUEST_RETRY_DELAY_US 10000
+#endif
+
+/**
+ * @details Number of retries in a row after which a queued request that cannot be sent for lack of buffers in the
+ * mesh stack ends with NRF_ERROR_NO_MEM
+ */
+#ifndef TIME_CLIENT_REQUEST_MAX_RETRIES
+#define TIME_CLIENT_REQUEST_MAX_RETRIES 100
+#endif
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE && (TIME_CLIENT_MAX_IN_FLIGHT < 1 || TIME_CLIENT_MAX_IN_FLIGHT > 255)
+#error "TIME_CLIENT_MAX_IN_FLIGHT must be within 1 to 255"
+#endif
+
+/**
+ * @details Whether the fleet sweep is used, sending a Time Get to each of a range or list of unicast addresses
+ *
+ * The sweep keeps a window of requests in flight on the request queue and adapts it to the mesh: the window grows
+ * by one for each window of replies, and is halved on a timeout, at most once per window, as the timeouts of a
+ * congested mesh come in bursts. Requires TIME_CLIENT_REQUEST_QUEUE_SIZE.
+ */
+#ifndef TIME_CLIENT_SWEEP
+#define TIME_CLIENT_SWEEP 0
+#endif
+
+/** @details Number of requests in flight a sweep starts with */
+#ifndef TIME_CLIENT_SWEEP_INITIAL_WINDOW
+#define TIME_CLIENT_SWEEP_INITIAL_WINDOW 2
+#endif
+
+#if TIME_CLIENT_SWEEP && !TIME_CLIENT_REQUEST_QUEUE_SIZE
+#error "TIME_CLIENT_SWEEP requires TIME_CLIENT_REQUEST_QUEUE_SIZE"
+#endif
+
+#if TIME_CLIENT_SWEEP && (TIME_CLIENT_SWEEP_INITIAL_WINDOW < 1 || TIME_CLIENT_SWEEP_INITIAL_WINDOW > TIME_CLIENT_MAX_IN_FLIGHT)
+#error "TIME_CLIENT_SWEEP_INITIAL_WINDOW must be within 1 to TIME_CLIENT_MAX_IN_FLIGHT"
+#endif
+
+/**
+ * @details Number of nodes the fleet table of each client instance can hold, 0 to disable the fleet table
+ *
+ * The fleet table records the last Time Status received from each node, keyed by its unicast address, along
+ * with the local uptime it was received at and the estimated skew of the node clock relative to the local one.
+ * It must be a power of 2, and nodes beyond it are not recorded.
+ *
+ * NOTE: The local uptime is timer_now(), extended to 64 bits on each received Time Status and by a periodic
+ * timer_scheduler event every quarter of a wrap of timer_now(), so it stays consistent without any traffic.
+ */
+#ifndef TIME_CLIENT_FLEET_TABLE_SIZE
+#define TIME_CLIENT_FLEET_TABLE_SIZE 0
+#endif
+
+#if (TIME_CLIENT_FLEET_TABLE_SIZE & (TIME_CLIENT_FLEET_TABLE_SIZE - 1)) || TIME_CLIENT_FLEET_TABLE_SIZE > 0x4000
+#error "TIME_CLIENT_FLEET_TABLE_SIZE must be a power of 2 up to 16384"
+#endif
+
+/** @details Minimum local interval in seconds between the two Time Status messages a skew sample is measured over */
+#ifndef TIME_CLIENT_FLEET_SKEW_MIN_INTERVAL_S
+#define TIME_CLIENT_FLEET_SKEW_MIN_INTERVAL_S 60
+#endif
+
+/** @details Skew samples beyond this many parts per million are taken as a resync of the node, and restart its estimate */
+#ifndef TIME_CLIENT_FLEET_MAX_SKEW_PPM
+#define TIME_CLIENT_FLEET_MAX_SKEW_PPM 1000
+#endif
+
+/** @details Weight of each new skew sample in the skew estimate, as a power of 2 divisor */
+#ifndef TIME_CLIENT_FLEET_SKEW_EWMA_SHIFT
+#define TIME_CLIENT_FLEET_SKEW_EWMA_SHIFT 3
+#endif
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE || TIME_CLIENT_FLEET_TABLE_SIZE
+#include "timer_scheduler.h"
+#endif
+
 #define TIME_CLIENT_DEFAULT_SETTINGS { \
     .settings.timeout = 0, \
     .settings.force_segmented = false, \
@@ -63,8 +162,39 @@ typedef void (*time_status_cb_client_t)(const time_client_t * p_self,
 					const access_message_rx_meta_t * p_meta,
 					const time_status_params_t * p_in);
 
+typedef void (*time_zone_status_cb_client_t)(const time_client_t * p_self,
+					     const access_message_rx_meta_t * p_meta,
+					     const time_zone_status_params_t * p_in);
+
+typedef void (*tai_utc_delta_status_cb_client_t)(const time_client_t * p_self,
+						 const access_message_rx_meta_t * p_meta,
+						 const tai_utc_delta_status_params_t * p_in);
+
+typedef void (*time_role_status_cb_client_t)(const time_client_t * p_self,
+					     const access_message_rx_meta_t * p_meta,
+					     const time_role_status_params_t * p_in);
+
+/**
+ * Callback ending a queued Time Get request
+ *
+ * @param[in]   p_self      Client model context pointer
+ * @param[in]   dst         Unicast address the request was sent to
+ * @param[in]   status      NRF_SUCCESS if the Time Status was received, NRF_ERROR_TIMEOUT if it was not received
+ *                          within the timeout, or the error from the mesh stack if the request could not be sent
+ * @param[in]   p_in        Received Time Status, NULL unless status is NRF_SUCCESS
+ * @param[in]   p_context   Context pointer given when queuing the request
+ */
+typedef void (*time_client_request_cb_t)(const time_client_t * p_self,
+					 uint16_t dst,
+					 uint32_t status,
+					 const time_status_params_t * p_in,
+					 void * p_context);
+
 typedef struct {
     time_status_cb_client_t time_status_cb;
+    time_zone_status_cb_client_t time_zone_status_cb;
+    tai_utc_delta_status_cb_client_t tai_utc_delta_status_cb;
+    time_role_status_cb_client_t time_role_status_cb;
     /** Callback to call after the acknowledged transaction has ended. */
     access_reliable_cb_t ack_transaction_status_cb;
     /** callback called at the end of the each period for the publishing */
@@ -83,17 +213,165 @@ typedef struct {
     bool force_segmented;
     /** TransMIC size used by the outgoing server messages. */
     nrf_mesh_transmic_size_t transmic_size;
+    /** Maximum number of queued requests in flight at once. If this value is set to zero or above
+     * @ref TIME_CLIENT_MAX_IN_FLIGHT, during model initialization it will be updated to that value. */
+    uint8_t max_in_flight;
 } time_client_settings_t;
 
+#if TIME_CLIENT_SWEEP
+/** Outcome of a finished sweep */
+typedef struct {
+    /** Time from the start of the sweep to its last reply or timeout, in microseconds */
+    uint32_t duration_us;
+    /** Number of nodes swept, and how many of them replied, timed out or could not be sent to */
+    uint16_t node_count;
+    uint16_t reply_count;
+    uint16_t timeout_count;
+    uint16_t error_count;
+    /** Number of requests in flight the sweep had adapted to by its end */
+    uint8_t window;
+    /** Whether the sweep was stopped before all of its nodes ended, the counts then only cover the ones that did */
+    bool cancelled;
+} time_client_sweep_report_t;
+
+typedef void (*time_client_sweep_done_cb_t)(const time_client_t * p_self,
+					    const time_client_sweep_report_t * p_report);
+
+/** Sweep state */
+typedef struct {
+    /** Addresses to sweep, either p_list[0..count - 1], or first to first + count - 1 if p_list is NULL */
+    const uint16_t * p_list;
+    uint16_t first;
+    uint16_t count;
+    /** Index of the next address to send to */
+    uint16_t next;
+    /** Number of requests of the sweep queued or in flight */
+    uint16_t outstanding;
+    /** Current window, and the replies counted towards growing it */
+    uint8_t window;
+    uint8_t window_credit;
+    /** settings.max_in_flight before the sweep, restored at its end */
+    uint8_t saved_max_in_flight;
+    /** Sequence numbers of the requests, of the first request of this sweep, and of the first request
+     * sent after the last window decrease */
+    uint32_t seq;
+    uint32_t base_seq;
+    uint32_t decrease_seq;
+    /** Time the sweep started at */
+    timestamp_t start;
+    /** Callbacks for each node and for the end of the sweep */
+    time_client_request_cb_t result_cb;
+    time_client_sweep_done_cb_t done_cb;
+    /** Running report */
+    time_client_sweep_report_t report;
+    bool active;
+    /** Whether requests are being queued for the sweep, so that the requests ending meanwhile do not queue more */
+    bool filling;
+} time_client_sweep_t;
+#endif
+
+#if TIME_CLIENT_FLEET_TABLE_SIZE
+/** Fleet table entry, holding the last Time Status received from a node */
+typedef struct {
+    /** Unicast address of the node */
+    uint16_t src;
+    /** Last received time, uncertainty and authority */
+    uint64_t tai_seconds : 40;
+    uint64_t subsecond : 8;
+    uint64_t uncertainty : 8;
+    uint64_t time_authority : 1;
+    /** Local uptime the last Time Status was received at, in microseconds */
+    uint64_t rx_time_us;
+    /**
+     * Received time minus the local uptime it was received at, in microseconds, i.e. the time of the node at local
+     * uptime 0, or 0 while the node has no known time. The uptime is not a TAI time, so this is not an offset
+     * between the clocks: the time_base_us of two nodes are compared with each other, or with the TAI time of
+     * the local node minus its uptime
+     */
+    int64_t time_base_us;
+    /** Estimated rate of the node clock relative to the local clock, in parts per billion */
+    int32_t skew_ppb;
+    /** Number of Time Status messages received from the node */
+    uint32_t status_count;
+    /** Local and received times of the sample the next skew sample is measured from */
+    uint64_t skew_ref_rx_time_us;
+    uint64_t skew_ref_time_us;
+    /** Whether skew_ppb holds an estimate */
+    bool skew_valid;
+} time_client_fleet_entry_t;
+#endif
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+/** Queued Time Get request */
+typedef struct {
+    /** Unicast address the request is sent to */
+    uint16_t dst;
+    /** Time at which the request times out, only valid while it is in flight */
+    timestamp_t deadline;
+    /** Callback ending the request, and its context pointer */
+    time_client_request_cb_t cb;
+    void * p_context;
+} time_client_request_t;
+#endif
+
 /** Model struct definition */
 struct __time_client_t {
     /** Model handle assigned to this instance */
     access_model_handle_t model_handle;
     /** Acknowledged message context variable */
     access_reliable_t access_message;
+    /** 
+     * Payload of the acknowledged message, kept until the end of the transaction for its retransmissions.
+     * The Time Set message is the longest of the Set messages
+     */
+    uint8_t msg_pkt[TIME_SET_LEN];
 
     /** Model settings and callbacks for this instance */
     time_client_settings_t settings;
+
+    /** Callbacks of this instance, see time_client_set_callbacks() */
+    time_client_callbacks_t callbacks;
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+    /** Requests waiting to be sent, as a ring buffer in the order they were queued */
+    time_client_request_t pending[TIME_CLIENT_REQUEST_QUEUE_SIZE];
+    uint16_t pending_head;
+    uint16_t pending_count;
+
+    /** Number of retries in a row of the request at pending_head */
+    uint8_t pending_retries;
+
+    /** Requests sent and waiting for their Time Status */
+    time_client_request_t in_flight[TIME_CLIENT_MAX_IN_FLIGHT];
+    uint8_t in_flight_count;
+
+    /** Timer for the request timeouts and for the retries when the mesh stack is out of buffers */
+    timer_event_t request_timer;
+#endif
+
+#if TIME_CLIENT_SWEEP
+    /** Sweep in progress, if any */
+    time_client_sweep_t sweep;
+#endif
+
+#if TIME_CLIENT_FLEET_TABLE_SIZE
+    /** Fleet table entries, in the order the nodes were first heard from */
+    time_client_fleet_entry_t fleet[TIME_CLIENT_FLEET_TABLE_SIZE];
+    uint16_t fleet_count;
+
+    /** Open addressed index of the entries by unicast address, with a load factor of at most 1/2 */
+    uint16_t fleet_index[TIME_CLIENT_FLEET_TABLE_SIZE * 2];
+
+    /** Number of Time Status messages from nodes that did not fit in the table */
+    uint32_t fleet_dropped;
+
+    /** Local time extended to 64 bits, and the timer_now() value it was last extended at */
+    uint64_t fleet_local_time_us;
+    timestamp_t fleet_local_timestamp;
+
+    /** Timer extending the local time before timer_now() wraps */
+    timer_event_t fleet_timer;
+#endif
 };
 
 /**
@@ -119,12 +397,15 @@ struct __time_client_t {
 uint32_t time_client_init(time_client_t * p_client, uint8_t element_index);
 
 /**
- * Sets the callbacks of the model for the main application to receive events from the model
+ * Sets the callbacks of the model instance for the main application to receive events from it
  * 
- * @param[in]   p_callbacks     Pointer to a struct containing callbacks for the main application
+ * @param[in]   p_client        Client model context pointer
+ * @param[in]   p_callbacks     Pointer to a struct containing callbacks for the main application, copied into the instance
  * 
+ * @retval NRF_SUCCESS              The callbacks were set successfully.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
  */
-void time_client_set_callbacks(time_client_callbacks_t * p_callbacks);
+uint32_t time_client_set_callbacks(time_client_t * p_client, const time_client_callbacks_t * p_callbacks);
 
 /**
  * Publishes a Time Get message
@@ -147,4 +428,342 @@ void time_client_set_callbacks(time_client_callbacks_t * p_callbacks);
  * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
  */ 
 uint32_t time_client_time_get(time_client_t * p_client);
+
+/**
+ * Publishes a Time Zone Get message
+ * 
+ * @note As per the Bluetooth Mesh specification, it is expected to receive
+ * a Time Zone Status message from nodes that receive this message that support the 
+ * Time Server model
+ *  
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_BUSY           The model is busy publishing another message.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Incorrect transition parameters,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_time_zone_get(time_client_t * p_client);
+
+/**
+ * Publishes a TAI-UTC Delta Get message
+ * 
+ * @note As per the Bluetooth Mesh specification, it is expected to receive
+ * a TAI-UTC Delta Status message from nodes that receive this message that support the 
+ * Time Server model
+ *  
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_BUSY           The model is busy publishing another message.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Incorrect transition parameters,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_tai_utc_delta_get(time_client_t * p_client);
+
+/**
+ * Publishes a Time Role Get message
+ * 
+ * @note As per the Bluetooth Mesh specification, it is expected to receive
+ * a Time Role Status message from nodes that receive this message that support the 
+ * Time Setup Server model
+ *  
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_BUSY           The model is busy publishing another message.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Incorrect transition parameters,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_time_role_get(time_client_t * p_client);
+
+/**
+ * Publishes a Time Set message as an acknowledged transaction, which ends when
+ * the Time Status message is received or times out
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_params    Parameters of the message
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_BUSY           The model is busy publishing another message.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid parameters in p_params,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_time_set(time_client_t * p_client, const time_set_params_t * p_params);
+
+/**
+ * Publishes a Time Set message without a transaction
+ * 
+ * @note The receiving Time Setup Servers still reply with a Time Status message
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_params    Parameters of the message
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid parameters in p_params,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_time_set_unack(time_client_t * p_client, const time_set_params_t * p_params);
+
+/**
+ * Publishes a Time Zone Set message as an acknowledged transaction, which ends when
+ * the Time Zone Status message is received or times out
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_params    Parameters of the message
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_BUSY           The model is busy publishing another message.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid parameters in p_params,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_time_zone_set(time_client_t * p_client, const time_zone_set_params_t * p_params);
+
+/**
+ * Publishes a Time Zone Set message without a transaction
+ * 
+ * @note The receiving Time Setup Servers still reply with a Time Zone Status message
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_params    Parameters of the message
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid parameters in p_params,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_time_zone_set_unack(time_client_t * p_client, const time_zone_set_params_t * p_params);
+
+/**
+ * Publishes a TAI-UTC Delta Set message as an acknowledged transaction, which ends when
+ * the TAI-UTC Delta Status message is received or times out
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_params    Parameters of the message
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_BUSY           The model is busy publishing another message.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid parameters in p_params,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_tai_utc_delta_set(time_client_t * p_client, const tai_utc_delta_set_params_t * p_params);
+
+/**
+ * Publishes a TAI-UTC Delta Set message without a transaction
+ * 
+ * @note The receiving Time Setup Servers still reply with a TAI-UTC Delta Status message
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_params    Parameters of the message
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid parameters in p_params,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_tai_utc_delta_set_unack(time_client_t * p_client, const tai_utc_delta_set_params_t * p_params);
+
+/**
+ * Publishes a Time Role Set message as an acknowledged transaction, which ends when
+ * the Time Role Status message is received or times out
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_params    Parameters of the message
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_BUSY           The model is busy publishing another message.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid parameters in p_params,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_time_role_set(time_client_t * p_client, const time_role_set_params_t * p_params);
+
+/**
+ * Publishes a Time Role Set message without a transaction
+ * 
+ * @note The receiving Time Setup Servers still reply with a Time Role Status message
+ * 
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_params    Parameters of the message
+ * 
+ * @retval NRF_SUCCESS              The message is handed over to the mesh stack for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_NO_MEM         No memory available to send the message at this point.
+ * @retval NRF_ERROR_NOT_FOUND      The model is not initialized.
+ * @retval NRF_ERROR_INVALID_PARAM  Invalid parameters in p_params,
+ *                                  the model not bound to application key,
+ *                                  or publish address not set.
+ * @retval NRF_ERROR_FORBIDDEN      Failed to allocate a sequence number from network.
+ */ 
+uint32_t time_client_time_role_set_unack(time_client_t * p_client, const time_role_set_params_t * p_params);
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+/**
+ * Queues a Time Get request to a unicast address
+ *
+ * The request is sent as soon as there are less than max_in_flight requests in flight, and ends
+ * with a call to cb, exactly once, unless it is cancelled with time_client_requests_cancel().
+ *
+ * @note Requests are handled in the mesh context, so this function should be called from
+ * the same interrupt priority as the mesh stack
+ *
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   dst         Unicast address to send the request to
+ * @param[in]   cb          Callback ending the request
+ * @param[in]   p_context   Context pointer given to cb
+ *
+ * @retval NRF_SUCCESS              The request is queued.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_INVALID_ADDR   dst is not a unicast address.
+ * @retval NRF_ERROR_NO_MEM         TIME_CLIENT_REQUEST_QUEUE_SIZE requests are already queued.
+ */
+uint32_t time_client_time_get_queue(time_client_t * p_client, uint16_t dst, time_client_request_cb_t cb, void * p_context);
+
+/**
+ * Drops all the queued and in flight requests, without calling their callbacks. A sweep in progress
+ * is stopped as with time_client_sweep_stop(), so its done_cb reports it as cancelled
+ *
+ * @param[in]   p_client    Client model context pointer
+ */
+void time_client_requests_cancel(time_client_t * p_client);
+#endif
+
+#if TIME_CLIENT_SWEEP
+/**
+ * Starts a sweep sending a Time Get to each unicast address from first to last inclusive
+ *
+ * result_cb is called for each node as in time_client_time_get_queue(), with a NULL p_context, and done_cb
+ * once all of them have ended. The window of the sweep is applied to settings.max_in_flight while it runs.
+ *
+ * @note The sweep needs free room in the request queue, so it should not be shared with a lot of other requests
+ *
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   first       First unicast address to sweep
+ * @param[in]   last        Last unicast address to sweep
+ * @param[in]   result_cb   Callback for each node
+ * @param[in]   done_cb     Callback for the end of the sweep, can be NULL
+ *
+ * @retval NRF_SUCCESS              The sweep is started.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_INVALID_ADDR   The range is empty or not all unicast addresses.
+ * @retval NRF_ERROR_INVALID_STATE  A sweep is already in progress.
+ */
+uint32_t time_client_sweep_range_start(time_client_t * p_client, uint16_t first, uint16_t last,
+                                       time_client_request_cb_t result_cb, time_client_sweep_done_cb_t done_cb);
+
+/**
+ * Starts a sweep sending a Time Get to each unicast address of a list, see time_client_sweep_range_start()
+ *
+ * @note The list is not copied, and must stay valid until the end of the sweep
+ *
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   p_list      Unicast addresses to sweep
+ * @param[in]   count       Number of addresses in p_list
+ * @param[in]   result_cb   Callback for each node
+ * @param[in]   done_cb     Callback for the end of the sweep, can be NULL
+ *
+ * @retval NRF_SUCCESS              The sweep is started.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_INVALID_ADDR   The list is empty or has an address that is not a unicast address.
+ * @retval NRF_ERROR_INVALID_STATE  A sweep is already in progress.
+ */
+uint32_t time_client_sweep_list_start(time_client_t * p_client, const uint16_t * p_list, uint16_t count,
+                                      time_client_request_cb_t result_cb, time_client_sweep_done_cb_t done_cb);
+
+/**
+ * Stops the sweep in progress, if any. done_cb is called right away with the report so far, with
+ * cancelled set. The requests of the sweep already queued or in flight still end, but result_cb
+ * is not called for them anymore
+ *
+ * @param[in]   p_client    Client model context pointer
+ */
+void time_client_sweep_stop(time_client_t * p_client);
+#endif
+
+#if TIME_CLIENT_FLEET_TABLE_SIZE
+/**
+ * Looks a node up in the fleet table
+ *
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   src         Unicast address of the node
+ *
+ * @return  The entry of the node, or NULL if no Time Status has been recorded from it
+ */
+const time_client_fleet_entry_t * time_client_fleet_find(const time_client_t * p_client, uint16_t src);
+
+/**
+ * Gets the number of nodes in the fleet table. The entries are at indexes 0 to this number - 1 of
+ * time_client_fleet_get(), in the order the nodes were first heard from
+ *
+ * @param[in]   p_client    Client model context pointer
+ */
+uint16_t time_client_fleet_count_get(const time_client_t * p_client);
+
+/**
+ * Gets a fleet table entry by index, for iterating over all the nodes
+ *
+ * @param[in]   p_client    Client model context pointer
+ * @param[in]   index       Index of the entry, below time_client_fleet_count_get()
+ *
+ * @return  The entry, or NULL if index is out of range
+ */
+const time_client_fleet_entry_t * time_client_fleet_get(const time_client_t * p_client, uint16_t index);
+
+/**
+ * Empties the fleet table
+ *
+ * @param[in]   p_client    Client model context pointer
+ */
+void time_client_fleet_clear(time_client_t * p_client);
+#endif
 #endif
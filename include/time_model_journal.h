@@ -0,0 +1,158 @@
+/**
+ * MIT License
+ * Copyright (c) [2022] [Jefferson Zhai]
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef TIME_MODEL_JOURNAL_H
+#define TIME_MODEL_JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file time_model_journal.h
+ * @brief Journal of the Time Server state in flash
+ * @version 0.1
+ * 
+ * @details Each change of the saved state appends a record holding all of it to the active flash page,
+ * so restoring it only needs the last record. When the active page is full, the journal moves on to the
+ * next page, erasing it first, so that the erases are spread over all the pages of the journal in turn.
+ * 
+ * Each page starts with a header holding its sequence number, which tells the active page apart with
+ * one read per page, and the records of a page are written in order, so its last record is found with
+ * a binary search for the first erased slot instead of a scan of the whole journal.
+ * 
+ * The flash is accessed through time_model_flash_t, so that any flash driver can be plugged in.
+ * 
+ */
+
+/** Value of the erased flash */
+#define TIME_MODEL_FLASH_ERASED_WORD (0xFFFFFFFF)
+
+/**
+ * Flash backend of the journal. Writes only ever clear bits of erased words, 4 byte aligned, and
+ * each function returns NRF_SUCCESS or an NRF_ERROR_* code.
+ * 
+ * @note The functions are expected to have completed when they return, as the journal reads back
+ * what it wrote.
+ */
+typedef struct {
+    uint32_t (*read)(void * p_context, uint32_t offset, void * p_data, uint32_t length);
+    uint32_t (*write)(void * p_context, uint32_t offset, const void * p_data, uint32_t length);
+    uint32_t (*erase_page)(void * p_context, uint32_t page);
+    /** Context pointer given to the functions */
+    void * p_context;
+    /** Size of a page in bytes, a multiple of 4 */
+    uint32_t page_size;
+    /** Number of pages of the journal, at least 2 */
+    uint16_t page_count;
+} time_model_flash_t;
+
+/** Saved state, in the encoding of the messages for the Time Zone Offset and TAI-UTC Delta */
+typedef struct {
+    uint64_t tai_seconds;
+    uint8_t subsecond;
+    uint8_t uncertainty;
+    uint8_t time_role;
+
+    uint64_t time_zone_change;
+    uint8_t time_zone_offset_current;
+    uint8_t time_zone_offset_new;
+
+    uint64_t tai_utc_delta_change;
+    uint16_t tai_utc_delta_current;
+    uint16_t tai_utc_delta_new;
+
+    uint16_t subsecond_fraction;
+    /** Retained counter value at tai_seconds with TIME_MODEL_WARM_START, otherwise the RTC counter value,
+     *  or 0 without TIME_MODEL_USE_APP_TIMER */
+    uint32_t anchor_tick;
+    /** TAI seconds of the last sync, see time_server_t::last_sync_time */
+    uint64_t last_sync_tai_seconds;
+} time_model_saved_state_t;
+
+/**
+ * Size of the saved state in a record. It is stored with its fields at fixed little-endian byte offsets by
+ * time_model_msg_encode(), like a message, see the field table in time_model_journal.c, so that the records do
+ * not depend on the compiler or CPU, and padded to a multiple of 4 bytes for the flash writes
+ */
+#define TIME_MODEL_SAVED_STATE_SIZE (36)
+
+/** Journal record, with the sequence number first so that an erased slot reads as TIME_MODEL_FLASH_ERASED_WORD */
+typedef struct {
+    uint32_t seq;
+    /** CRC-32 of the sequence number and of the bytes of the state */
+    uint32_t crc;
+    uint8_t state[TIME_MODEL_SAVED_STATE_SIZE];
+} time_model_journal_record_t;
+
+/** Journal context */
+typedef struct {
+    /** Flash backend */
+    const time_model_flash_t * p_flash;
+    /** Active page, its sequence number and the slot the next record goes to */
+    uint16_t page;
+    uint32_t page_seq;
+    uint32_t next_slot;
+    /** Sequence number of the last record written */
+    uint32_t seq;
+    /** Last valid record, read once when the journal is opened */
+    time_model_journal_record_t last;
+    bool has_last;
+} time_model_journal_t;
+
+/**
+ * Opens the journal, finding the active page and its last valid record, or formats the flash
+ * if it holds no journal yet
+ * 
+ * @param[out]  p_journal   Journal context
+ * @param[in]   p_flash     Flash backend, kept for the lifetime of the journal
+ * 
+ * @retval NRF_SUCCESS              The journal is opened.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_INVALID_PARAM  The flash has less than 2 pages, or its pages cannot hold a record.
+ * @return Errors of the flash backend
+ */
+uint32_t time_model_journal_open(time_model_journal_t * p_journal, const time_model_flash_t * p_flash);
+
+/**
+ * Gets the last saved state
+ * 
+ * @param[in]   p_journal   Journal context
+ * @param[out]  p_state     Last saved state
+ * 
+ * @retval NRF_SUCCESS              The state is read.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @retval NRF_ERROR_NOT_FOUND      No state is saved.
+ */
+uint32_t time_model_journal_read(const time_model_journal_t * p_journal, time_model_saved_state_t * p_state);
+
+/**
+ * Appends a state to the journal, moving on to the next page if the active one is full
+ * 
+ * @param[in]   p_journal   Journal context
+ * @param[in]   p_state     State to save
+ * 
+ * @retval NRF_SUCCESS              The state is saved.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ * @return Errors of the flash backend
+ */
+uint32_t time_model_journal_write(time_model_journal_t * p_journal, const time_model_saved_state_t * p_state);
+
+#endif
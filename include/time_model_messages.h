@@ -21,8 +21,12 @@
 */
 #ifndef TIME_MODEL_MESSAGES_H
 #define TIME_MODEL_MESSAGES_H
+#include <stddef.h>
 #include <stdint.h>
 
+#include "time_model_common.h"
+#include "time_model_stats.h"
+
 /**
  * @file time_model_messages.h
  * @author Jefferson Zhai ()
@@ -37,6 +41,9 @@
  * 
  */
 
+/** The Time Get, Time Zone Get, TAI-UTC Delta Get and Time Role Get messages have no payload */
+#define TIME_MODEL_GET_LEN 0
+
 /** Size of the Time Set message payload according to Section 5.2.1.2 */
 #define TIME_SET_LEN 10
 
@@ -62,6 +69,33 @@
 /** Size of the Time Role Status message payload according to Section 5.2.1.12 */
 #define TIME_ROLE_STATUS_LEN 1
 
+/**
+ * @details The opcode handler tables of the models are generated from lists of the messages they handle, of the form
+ *
+ *     #define MODEL_OPCODES(X) \
+ *         X(opcode, handler, min_length, max_length) \
+ *         ...
+ *
+ * MODEL_OPCODES(TIME_MODEL_OPCODE_HANDLER_DEFINE) defines a wrapper for each handler which drops the messages
+ * whose payload length is out of [min_length, max_length] before the handler reads any of it, and only counts
+ * the messages it passes on in the TIME_MODEL_STATS handler counters and run times, and
+ * MODEL_OPCODES(TIME_MODEL_OPCODE_TABLE_ENTRY) gives the entries of the access_opcode_handler_t table, so that
+ * a message, its length and its handler can only be added or changed together.
+ */
+#define TIME_MODEL_OPCODE_HANDLER_DEFINE(opcode, handler, min_length, max_length)                     \
+    TIME_MODEL_STATS_HANDLER_DEFINE(handler)                                                          \
+    static void handler##_checked(access_model_handle_t model_handle,                                  \
+                                  const access_message_rx_t * p_rx_msg, void * p_args) {               \
+        if ((uint32_t) (p_rx_msg->length - (min_length)) > (uint32_t) ((max_length) - (min_length))) { \
+            TIME_MODEL_STATS_RX_INVALID(opcode);                                                      \
+            return;                                                                                   \
+        }                                                                                             \
+        TIME_MODEL_STATS_HANDLER(handler)(model_handle, p_rx_msg, p_args);                            \
+    }
+
+#define TIME_MODEL_OPCODE_TABLE_ENTRY(opcode, handler, min_length, max_length) \
+    {ACCESS_OPCODE_SIG(opcode), handler##_checked},
+
 /** Time model opcodes, Section 7.1 */
 typedef enum {
     TIME_OPCODE_GET = 0x8237,
@@ -78,65 +112,177 @@ typedef enum {
     TIME_OPCODE_TAI_UTC_DELTA_STATUS = 0x8240
 } time_model_opcode_t;
 
-/** Message packet definition for the Time Set Message, Section 5.2.1.2, Table 5.15 */
-typedef struct __attribute((packed)) {
-    uint64_t tai_seconds : 40;
+/**
+ * @details The messages are held in the structs below, one member per field, and converted from and to their
+ * payload by time_model_msg_decode() and time_model_msg_encode() with the format of the message. The payloads are
+ * little-endian and their fields are not byte aligned, so they are read and written a byte at a time, which gives
+ * the same bytes with any compiler and on any CPU, unlike a packed struct with bitfields.
+ */
+
+/** Fields of the Time Set Message, Section 5.2.1.2, Table 5.15 */
+typedef struct {
+    uint64_t tai_seconds;
     uint8_t subsecond;
     uint8_t uncertainty;
-    uint8_t time_authority : 1;
-    uint16_t tai_utc_delta : 15;
+    uint8_t time_authority;
+    uint16_t tai_utc_delta;
     uint8_t time_zone_offset;
 } time_set_msg_pkt_t;
 
-/** Message packet definition for the Time Status Message, Section 5.2.1.3, Table 5.16 */
-typedef struct __attribute((packed)) {
-    uint64_t tai_seconds : 40;
+/** Fields of the Time Status Message, Section 5.2.1.3, Table 5.16 */
+typedef struct {
+    uint64_t tai_seconds;
     uint8_t subsecond;
     uint8_t uncertainty;
-    uint8_t time_authority : 1;
-    uint16_t tai_utc_delta : 15;
+    uint8_t time_authority;
+    uint16_t tai_utc_delta;
     uint8_t time_zone_offset;
 } time_status_msg_pkt_t;
 
-/** Message packet definition for the Time Zone Set Message, Section 5.2.1.5, Table 5.17 */
-typedef struct __attribute((packed)) {
+/** Fields of the Time Zone Set Message, Section 5.2.1.5, Table 5.17 */
+typedef struct {
     uint8_t time_zone_offset_new;
-    uint64_t time_zone_change : 40;
+    uint64_t time_zone_change;
 } time_zone_set_msg_pkt_t;
 
-/** Message packet definition for the Time Zone Status Message, Section 5.2.1.6, Table 5.18 */
-typedef struct __attribute((packed)) {
+/** Fields of the Time Zone Status Message, Section 5.2.1.6, Table 5.18 */
+typedef struct {
     uint8_t time_zone_offset_current;
     uint8_t time_zone_offset_new;
-    uint64_t time_zone_change : 40;
+    uint64_t time_zone_change;
 } time_zone_status_msg_pkt_t;
 
-/** Message packet definition for the TAI Delta Set Message, Section 5.2.1.8, Table 5.19 */
-typedef struct __attribute((packed)) {
-    uint16_t tai_utc_delta_new : 15;
-    uint8_t padding : 1;
-    uint64_t tai_utc_delta_change : 40;
+/** Fields of the TAI Delta Set Message, Section 5.2.1.8, Table 5.19 */
+typedef struct {
+    uint16_t tai_utc_delta_new;
+    uint64_t tai_utc_delta_change;
 } tai_utc_delta_set_msg_pkt_t;
 
-/** Message packet definition for the TAI Delta Status Message, Section 5.2.1.9, Table 5.20 */
-typedef struct __attribute((packed)) {
-    uint16_t tai_utc_delta_current : 15;
-    uint8_t padding1 : 1;
-    uint16_t tai_utc_delta_new : 15;
-    uint8_t padding2 : 1;
-    uint64_t tai_utc_delta_change : 40;
+/** Fields of the TAI Delta Status Message, Section 5.2.1.9, Table 5.20 */
+typedef struct {
+    uint16_t tai_utc_delta_current;
+    uint16_t tai_utc_delta_new;
+    uint64_t tai_utc_delta_change;
 } tai_utc_delta_status_msg_pkt_t;
 
-/** Message packet defintion for the Time Role Set message, Section 5.2.1.11, Table 5.21 */
-typedef struct __attribute((packed)) {
+/** Fields of the Time Role Set message, Section 5.2.1.11, Table 5.21 */
+typedef struct {
     uint8_t time_role;
 } time_role_set_msg_pkt_t;
 
-/** Message packet defintion for the Time Role Status message, Section 5.2.1.12, Table 5.22 */
-typedef struct __attribute((packed)) {
+/** Fields of the Time Role Status message, Section 5.2.1.12, Table 5.22 */
+typedef struct {
     uint8_t time_role;
 } time_role_status_msg_pkt_t;
 
+/** Field of a message: its bits in the payload, and its member in the struct of the message */
+typedef struct {
+    uint16_t bit_offset;
+    uint8_t bit_width;
+    uint8_t member_offset;
+    uint8_t member_size;
+} time_model_msg_field_t;
+
+/** Format of a message payload */
+typedef struct {
+    const time_model_msg_field_t * p_fields;
+    uint8_t field_count;
+    /** Length of the payload with all its fields */
+    uint8_t length;
+    /** Size of the struct of the message */
+    uint8_t msg_size;
+} time_model_msg_format_t;
+
+/** Field of the struct type, of up to 64 bits, at bit_offset in the payload */
+#define TIME_MODEL_MSG_FIELD(type, member, bit_offset, bit_width) \
+    {(bit_offset), (bit_width), offsetof(type, member), sizeof(((type *) 0)->member)}
+
+/** Format of a payload of msg_length bytes holding the fields of the struct type */
+#define TIME_MODEL_MSG_FORMAT(type, fields, msg_length) \
+    {(fields), sizeof(fields) / sizeof((fields)[0]), (msg_length), sizeof(type)}
+
+/** Formats of the messages, each to be used with the struct of the same name. The Time Status message has its own
+ * codec, time_status_msg_encode() and time_status_msg_decode() */
+extern const time_model_msg_format_t time_set_msg_format;
+extern const time_model_msg_format_t time_zone_set_msg_format;
+extern const time_model_msg_format_t time_zone_status_msg_format;
+extern const time_model_msg_format_t tai_utc_delta_set_msg_format;
+extern const time_model_msg_format_t tai_utc_delta_status_msg_format;
+extern const time_model_msg_format_t time_role_set_msg_format;
+extern const time_model_msg_format_t time_role_status_msg_format;
+
+/**
+ * @brief Writes the payload of a message. Padding bits are written as 0
+ * 
+ * @param[in] p_format  Format of the message
+ * @param[in] p_msg     Struct of the message
+ * @param[out] p_buffer Buffer for the payload, of at least p_format->length bytes
+ * 
+ * @return Length of the payload
+ */
+uint16_t time_model_msg_encode(const time_model_msg_format_t * p_format, const void * p_msg, uint8_t * p_buffer);
+
+/**
+ * @brief Reads the payload of a message. The fields which do not fit in a shorter payload, such as those of a
+ * Time Status message of an unknown time, are set to 0
+ * 
+ * @param[in] p_format  Format of the message
+ * @param[in] p_data    Payload
+ * @param[in] length    Length of the payload
+ * @param[out] p_msg    Struct of the message
+ */
+void time_model_msg_decode(const time_model_msg_format_t * p_format, const uint8_t * p_data, uint16_t length, void * p_msg);
+
+/**
+ * @brief Writes the payload of a Time Status message. Unlike the other messages, which go through
+ * time_model_msg_encode(), its layout is written out here: it is sent and received far more often than the others,
+ * on every publication and relay, and does not need to walk a field table
+ * 
+ * @param[in] p_msg     Struct of the message
+ * @param[out] p_buffer Buffer for the payload, of at least TIME_STATUS_MAXLEN bytes
+ * 
+ * @return Length of the payload with all its fields
+ */
+static inline uint16_t time_status_msg_encode(const time_status_msg_pkt_t * p_msg, uint8_t * p_buffer) {
+    p_buffer[0] = (uint8_t) p_msg->tai_seconds;
+    p_buffer[1] = (uint8_t) (p_msg->tai_seconds >> 8);
+    p_buffer[2] = (uint8_t) (p_msg->tai_seconds >> 16);
+    p_buffer[3] = (uint8_t) (p_msg->tai_seconds >> 24);
+    p_buffer[4] = (uint8_t) (p_msg->tai_seconds >> 32);
+    p_buffer[5] = p_msg->subsecond;
+    p_buffer[6] = p_msg->uncertainty;
+    p_buffer[7] = (uint8_t) ((p_msg->time_authority & 0x01) | (p_msg->tai_utc_delta << 1));
+    p_buffer[8] = (uint8_t) ((p_msg->tai_utc_delta >> 7) & 0xFF);
+    p_buffer[9] = p_msg->time_zone_offset;
+    return TIME_STATUS_MAXLEN;
+}
+
+/**
+ * @brief Reads the payload of a Time Status message, see time_status_msg_encode(). The fields after the TAI
+ * seconds are set to 0 when the payload is shorter than TIME_STATUS_MAXLEN
+ * 
+ * @param[in] p_data    Payload, of at least TIME_STATUS_MINLEN bytes
+ * @param[in] length    Length of the payload
+ * @param[out] p_msg    Struct of the message
+ */
+static inline void time_status_msg_decode(const uint8_t * p_data, uint16_t length, time_status_msg_pkt_t * p_msg) {
+    p_msg->tai_seconds = (uint64_t) p_data[0] | ((uint64_t) p_data[1] << 8) | ((uint64_t) p_data[2] << 16)
+                       | ((uint64_t) p_data[3] << 24) | ((uint64_t) p_data[4] << 32);
+    if (length < TIME_STATUS_MAXLEN) {
+        p_msg->subsecond = 0;
+        p_msg->uncertainty = 0;
+        p_msg->time_authority = 0;
+        p_msg->tai_utc_delta = 0;
+        p_msg->time_zone_offset = 0;
+        return;
+    }
+    p_msg->subsecond = p_data[5];
+    p_msg->uncertainty = p_data[6];
+    p_msg->time_authority = p_data[7] & 0x01;
+    p_msg->tai_utc_delta = (uint16_t) ((p_data[7] >> 1) | ((uint16_t) p_data[8] << 7));
+    p_msg->time_zone_offset = p_data[9];
+}
+
 /**
  * @brief Utility function to encode a Time Zone Offset parameter to 
  * the appropriate format for the message
@@ -26,6 +26,7 @@
 #include <stdbool.h>
 
 #include "time_model_common.h"
+#include "time_model_journal.h"
 #include "nrf_mesh.h"
 
 /**
@@ -44,17 +45,242 @@
  * @details Whether or not to use the included app timer library of the mesh SDK
  * If this setting is on, then make sure that the app_timer is initialized beforehand
  * 
- * NOTE: Currently, using this option is only supported when there is only 1 instance
- * of the time server/time setup server pair on the node, as only 1 app_timer instance is defined.
- * 
- * If for some reason you need multiple time servers/timer setup servers on the same node (this
- * case which I think is extremely rare), it is highly recommended to use your own timekeeping 
- * implementation to update the time server state instead
+ * All the time server/time setup server pairs on the node share a single app_timer instance, which
+ * is started for the earliest of their wakeups, so each additional pair only costs its RAM.
  */
 #ifndef TIME_MODEL_USE_APP_TIMER
 #define TIME_MODEL_USE_APP_TIMER 0
 #endif
 
+/**
+ * @details Whether the app timer timekeeping should run tickless
+ *
+ * Instead of waking up every second to increment the time state, the time server stores the RTC counter
+ * value of its last time update (the anchor) and computes the current time from it only when the time is
+ * actually read, i.e. when a Time Status is sent or time_server_state_get_time() is called. The app timer
+ * then only wakes up at pending Time Zone / TAI-UTC Delta change instants, and at least every
+ * TIME_MODEL_TICKLESS_MAX_SLEEP_MS so that the RTC counter cannot wrap around between two reads.
+ *
+ * NOTE: With this option, the tai_seconds and subsecond fields of the time server state are only brought
+ * up to date when read through the model, so use time_server_state_get_time() to read the current time.
+ */
+#ifndef TIME_MODEL_TICKLESS
+#define TIME_MODEL_TICKLESS 0
+#endif
+
+#if TIME_MODEL_TICKLESS && !TIME_MODEL_USE_APP_TIMER
+#error "TIME_MODEL_TICKLESS requires TIME_MODEL_USE_APP_TIMER"
+#endif
+
+/** Longest time the tickless timekeeping sleeps between wakeups, must be shorter than half the RTC counter wrap period */
+#ifndef TIME_MODEL_TICKLESS_MAX_SLEEP_MS
+#define TIME_MODEL_TICKLESS_MAX_SLEEP_MS (240000)
+#endif
+
+/**
+ * @details Whether the time server should discipline the rate of its clock from received Time Status messages
+ *
+ * Every sync from a Time Status message reveals how far the local clock has drifted since the previous one.
+ * When this option is on, these offsets are used to estimate the frequency error of the local oscillator
+ * (a frequency locked loop), which is then corrected for between syncs. This allows relays and clients to
+ * hold their accuracy with much longer Time Status publish periods.
+ *
+ * Requires TIME_MODEL_TICKLESS, as the 1 second app timer tick cannot tell the local time between two ticks.
+ */
+#ifndef TIME_MODEL_FREQUENCY_DISCIPLINE
+#define TIME_MODEL_FREQUENCY_DISCIPLINE 0
+#endif
+
+#if TIME_MODEL_FREQUENCY_DISCIPLINE && !TIME_MODEL_TICKLESS
+#error "TIME_MODEL_FREQUENCY_DISCIPLINE requires TIME_MODEL_TICKLESS"
+#endif
+
+/** Shortest interval the frequency error is measured over, as Time Status messages only have 1/256 second resolution */
+#ifndef TIME_MODEL_FLL_MIN_INTERVAL_S
+#define TIME_MODEL_FLL_MIN_INTERVAL_S (256)
+#endif
+
+/** Largest expected frequency error of the local oscillator in ppm, larger offsets are treated as time steps */
+#ifndef TIME_MODEL_FLL_MAX_PPM
+#define TIME_MODEL_FLL_MAX_PPM (500)
+#endif
+
+/** Gain of the frequency locked loop, as the power of 2 each measured frequency error is divided by */
+#ifndef TIME_MODEL_FLL_GAIN_SHIFT
+#define TIME_MODEL_FLL_GAIN_SHIFT (1)
+#endif
+
+/**
+ * @details Whether the uncertainty of the time state should grow with the time elapsed since it was last set
+ *
+ * According to Section 5.1.1.3, the uncertainty is the accuracy of the time state. A clock that has not been
+ * synced for a while has drifted, so with this option the uncertainty reported in Time Status messages is the
+ * uncertainty at the last sync or update, plus the drift accumulated since then at TIME_MODEL_UNCERTAINTY_DRIFT_PPM.
+ * With TIME_MODEL_FREQUENCY_DISCIPLINE, the remaining error of the estimated rate correction is used instead
+ * once it is known.
+ */
+#ifndef TIME_MODEL_UNCERTAINTY_GROWTH
+#define TIME_MODEL_UNCERTAINTY_GROWTH 0
+#endif
+
+/** Worst case drift of the local clock in ppm, used to grow the uncertainty */
+#ifndef TIME_MODEL_UNCERTAINTY_DRIFT_PPM
+#define TIME_MODEL_UNCERTAINTY_DRIFT_PPM (50)
+#endif
+
+/**
+ * @details Whether the time server should compensate for the delays a received Time Status message went through
+ *
+ * The time in a Time Status message is the time of the sender when it built the message, so it is already late
+ * by the time it is applied. With this option, the time applied from a received Time Status message is corrected by:
+ * - the measured residence time of the message in the local stack, from its reception by the radio to its handling
+ *   (only available for messages received through the advertising bearer)
+ * - TIME_MODEL_LINK_DELAY_US for every hop the message took, where the number of hops is taken from the
+ *   received TTL assuming the sender published with TIME_STATUS_MSG_TTL
+ *
+ * A relay that re-publishes the message then sends its corrected time, which includes the delays of all previous hops.
+ */
+#ifndef TIME_MODEL_DELAY_COMPENSATION
+#define TIME_MODEL_DELAY_COMPENSATION 0
+#endif
+
+/** Estimated delay between a Time Status message being published and being received one hop away, in microseconds */
+#ifndef TIME_MODEL_LINK_DELAY_US
+#define TIME_MODEL_LINK_DELAY_US (0)
+#endif
+
+/**
+ * @details Uncertainty added to a time for every hop it is relayed over, in 10 millisecond steps
+ *
+ * Time servers use the uncertainty of a received time as its stratum: they only sync to a Time Status message
+ * whose uncertainty, once this is added, is no worse than their own, and TIME RELAY nodes re-publish every time
+ * they sync. As a relayed time is always worse than the time it was relayed from, it can never loop back,
+ * while it still floods the whole mesh in a single pass. Must be at least 1.
+ */
+#ifndef TIME_MODEL_RELAY_HOP_UNCERTAINTY
+#define TIME_MODEL_RELAY_HOP_UNCERTAINTY (1)
+#endif
+
+#if TIME_MODEL_RELAY_HOP_UNCERTAINTY < 1
+#error "TIME_MODEL_RELAY_HOP_UNCERTAINTY must be at least 1 for relaying to be loop-free"
+#endif
+
+/**
+ * Shortest time between two syncs to Time Status messages of the same uncertainty, in milliseconds, so that the
+ * copies of a flood arriving over different paths are not relayed again
+ */
+#ifndef TIME_MODEL_RELAY_REFRESH_INTERVAL_MS
+#define TIME_MODEL_RELAY_REFRESH_INTERVAL_MS (500)
+#endif
+
+/**
+ * Time in seconds after the last sync from which a Time Status message less accurate than the current time is
+ * still synced to. Without TIME_MODEL_UNCERTAINTY_GROWTH the uncertainty of the time state does not grow between
+ * syncs, so this is what lets TIME RELAY nodes follow an authority whose uncertainty got larger, e.g. after it
+ * restarted. Should be several times the Time Status publish period of the authority.
+ */
+#ifndef TIME_MODEL_SYNC_MAX_AGE_S
+#define TIME_MODEL_SYNC_MAX_AGE_S (600)
+#endif
+
+/**
+ * @details Number of entries of the cache of recently received Time Status messages, 0 to disable it
+ *
+ * In dense meshes, a node may hear the same Time Status message several times over different paths. Received
+ * messages are looked up in a direct mapped cache keyed by their source address, TAI seconds and subsecond, and
+ * copies of a message already in it are dropped before they are handled at all. Entries age out on their own, as
+ * the time of later messages never matches them again. Messages of an unknown time are never dropped, as they
+ * would all have the same key. Must be a power of 2.
+ */
+#ifndef TIME_STATUS_DEDUP_CACHE_SIZE
+#define TIME_STATUS_DEDUP_CACHE_SIZE 0
+#endif
+
+#if (TIME_STATUS_DEDUP_CACHE_SIZE & (TIME_STATUS_DEDUP_CACHE_SIZE - 1)) != 0
+#error "TIME_STATUS_DEDUP_CACHE_SIZE must be a power of 2"
+#endif
+
+/**
+ * @details Hold-off window in milliseconds for the publications upon state change, 0 to publish immediately
+ *
+ * With publish_upon_state_change, every local state change publishes its own status message. When this is set,
+ * the status messages of all the state changes made within the window are merged, and each of them is published
+ * only once at its end, so that e.g. provisioning the time, time zone, TAI-UTC delta and role in a row costs one
+ * message of each kind instead of a burst. Requires TIME_MODEL_USE_APP_TIMER.
+ *
+ * NOTE: The local state set functions then return NRF_SUCCESS once the publication is scheduled, and errors of
+ * the publication itself are not reported.
+ */
+#ifndef TIME_MODEL_PUBLISH_HOLDOFF_MS
+#define TIME_MODEL_PUBLISH_HOLDOFF_MS 0
+#endif
+
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS && !TIME_MODEL_USE_APP_TIMER
+#error "TIME_MODEL_PUBLISH_HOLDOFF_MS requires TIME_MODEL_USE_APP_TIMER"
+#endif
+
+/**
+ * @details Enables time_server_state_snapshot(), which reads the time state consistently from any context
+ *
+ * The time state is written by the mesh handlers, the local set functions and the timer callback, and its
+ * fields cannot all be read at once, so a read interrupted by a write can mix the old and new values, e.g. the
+ * TAI seconds of one second with the subsecond of the next. When this is set, every change of the state is
+ * published to two copies in turn, each behind a sequence number, so that a reader always finds a copy that is
+ * not being written and never waits for a writer, even from an interrupt that preempted it.
+ */
+#ifndef TIME_MODEL_STATE_SNAPSHOT
+#define TIME_MODEL_STATE_SNAPSHOT 0
+#endif
+
+/**
+ * @details Whether the state is saved to a time_model_journal_t attached to the server
+ *
+ * The time role, the Time Zone Offset and TAI-UTC Delta states with their scheduled changes, and the time with
+ * its uncertainty and the RTC counter value it was taken at, are saved on each local or setup state change.
+ * They are saved on the syncs from received Time Status messages too, at most once every
+ * TIME_MODEL_PERSIST_SYNC_INTERVAL_S, to spare the flash. The role and the Time Zone Offset and TAI-UTC Delta
+ * states are restored by time_setup_server_init().
+ */
+#ifndef TIME_MODEL_PERSISTENCE
+#define TIME_MODEL_PERSISTENCE 0
+#endif
+
+/** @details Minimum interval in seconds between two saves of the state caused by syncs */
+#ifndef TIME_MODEL_PERSIST_SYNC_INTERVAL_S
+#define TIME_MODEL_PERSIST_SYNC_INTERVAL_S 3600
+#endif
+
+/**
+ * @details Whether the time is restored after a reset from the saved state and a counter that keeps running
+ * through resets, e.g. an RTC in a low power domain or with its own supply, instead of starting unknown
+ *
+ * The counter is read through time_server_t::retained_counter_get, which is saved with the time. On restore,
+ * the ticks elapsed since then give the current time, and the uncertainty grows with them at
+ * TIME_MODEL_UNCERTAINTY_DRIFT_PPM. Nodes then serve their time right after a reset instead of all asking
+ * an authority for it at once after a power cycle of the whole network. The time stays unknown if the
+ * uncertainty would go above TIME_MODEL_WARM_START_MAX_UNCERTAINTY. The time of the last sync is restored with
+ * it, so that a warm started time ages from the sync it came from. Requires TIME_MODEL_PERSISTENCE.
+ *
+ * NOTE: The counter must not wrap around more than once during the outage, which takes 36 hours at 32768 Hz.
+ */
+#ifndef TIME_MODEL_WARM_START
+#define TIME_MODEL_WARM_START 0
+#endif
+
+/** @details Frequency of the retained counter in Hz */
+#ifndef TIME_MODEL_RETAINED_COUNTER_FREQ
+#define TIME_MODEL_RETAINED_COUNTER_FREQ 32768
+#endif
+
+/** @details Largest uncertainty, in 10 millisecond steps, a warm started time may have */
+#ifndef TIME_MODEL_WARM_START_MAX_UNCERTAINTY
+#define TIME_MODEL_WARM_START_MAX_UNCERTAINTY 255
+#endif
+
+#if TIME_MODEL_WARM_START && !TIME_MODEL_PERSISTENCE
+#error "TIME_MODEL_WARM_START requires TIME_MODEL_PERSISTENCE"
+#endif
+
 /**
  * @details Time status message TTL - This should be set to 0 in most cases
  * 
@@ -104,11 +330,32 @@ typedef struct __time_setup_server_t time_setup_server_t;
     TIME SERVER AND SETUP SERVER STATE DEFINITION
 **********************************************************************/
 
+/** Entry of the cache of recently received Time Status messages */
+typedef struct {
+    uint64_t tai_seconds : 40;
+    uint64_t subsecond : 8;
+    uint64_t src : 16;
+} time_status_dedup_entry_t;
+
+/** State transitions that can be scheduled to happen at a given TAI time */
+typedef enum {
+    TIME_CHANGE_TIME_ZONE,
+    TIME_CHANGE_TAI_UTC_DELTA,
+    TIME_CHANGE_TYPE_COUNT
+} time_change_type_t;
+
+/** Pending state transition */
+typedef struct {
+    uint64_t tai_seconds : 40;
+    uint64_t type : 8;
+} time_change_t;
+
 /** State definition */
 typedef struct {
     uint64_t tai_seconds : 40;
     uint8_t subsecond;
-    uint8_t uncertainty;
+    uint16_t subsecond_fraction; //finer fraction of a second below subsecond, only kept internally for timekeeping
+    uint8_t uncertainty; //in 10 millisecond steps, at the last time it was set when TIME_MODEL_UNCERTAINTY_GROWTH is used
     bool time_authority;
     int16_t time_zone_offset_current; //allowed range -64 to +191 inclusive, in 15 second minutes intervals
     int16_t time_zone_offset_new; //allowed range -64 to +191 inclusive, in 15 second minutes intervals
@@ -126,11 +373,9 @@ typedef struct {
 **********************************************************************/
 /**
  * For implementations not using the build-in APP_TIMER in the model, the responsibility of updating
- * the time_server_state is on the user. If doing so, then note that largest gap to update 
- * the current tai_time is 1 second, otherwise the behaviour of the 
- * time server updating its time_zone / tai_utc_delta at the corresponding 
- * time_zone_change / tai_utc_delta_change time may fail, unless the code in the function
- * "static void current_time_check_time_changes()" is modified accordingly the user's time state update interval
+ * the time_server_state is on the user. Pending time_zone / tai_utc_delta changes are applied by
+ * these functions as soon as the time reaches or passes their time_zone_change / tai_utc_delta_change
+ * time, so the update interval only decides how late after that time a change can be applied
  */
 
 /**
@@ -142,6 +387,7 @@ void time_state_update_time(time_server_t * p_server, uint64_t tai_seconds, uint
 /**
  * @brief Update the TAI Delta state from elsewhere in the program, if available
  * 
+ * @note delta_subsecond is in 1/256 of a second and carries over into the TAI seconds
  */
 void time_state_update_time_delta(time_server_t * p_server, uint64_t delta_tai_seconds, uint8_t delta_subsecond);
 
@@ -151,6 +397,37 @@ void time_state_update_time_delta(time_server_t * p_server, uint64_t delta_tai_s
  */
 void time_state_update_uncertainty(time_server_t * p_server, uint8_t uncertainty);
 
+/**
+ * @brief Read the current time of the time state
+ *
+ * @note When TIME_MODEL_TICKLESS is enabled, this is where the time state is brought up to date
+ *
+ * @param[in]   p_server        Time Server model context pointer
+ * @param[out]  p_tai_seconds   Current TAI seconds
+ * @param[out]  p_subsecond     Current subsecond, in 1/256 of a second
+ *
+ * @retval NRF_SUCCESS              The time was read successfully.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ */
+uint32_t time_server_state_get_time(time_server_t * p_server, uint64_t * p_tai_seconds, uint8_t * p_subsecond);
+
+#if TIME_MODEL_STATE_SNAPSHOT
+/**
+ * @brief Read a consistent copy of the time state, from any context
+ *
+ * Unlike time_server_state_get_time(), this never writes the time server, so it can be called from interrupts
+ * and application threads at any rate. The copy is that of the last change of the state, with the time brought
+ * up to date when TIME_MODEL_TICKLESS is enabled, and with the uncertainty as it was last set.
+ *
+ * @param[in]   p_server        Time Server model context pointer
+ * @param[out]  p_state         Copy of the time state
+ *
+ * @retval NRF_SUCCESS              The state was read successfully.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ */
+uint32_t time_server_state_snapshot(const time_server_t * p_server, time_server_state_t * p_state);
+#endif
+
 
 /********************************************************************* 
     LOCAL MESSAGE ACTION FUNCTIONS
@@ -246,6 +523,20 @@ typedef struct {
     bool publish_upon_state_change;
 } time_server_settings_t;
 
+#if TIME_MODEL_STATE_SNAPSHOT
+/** Copy of the time state read by time_server_state_snapshot(), with what it takes to bring the time up to date */
+typedef struct {
+    time_server_state_t state;
+#if TIME_MODEL_TICKLESS
+    uint64_t anchor_time;
+    uint32_t anchor_tick;
+#endif
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    int32_t drift_ppb;
+#endif
+} time_server_state_copy_t;
+#endif
+
 /** Model struct definition */
 struct __time_server_t {
     /** Model handle assigned to this instance. */
@@ -254,20 +545,108 @@ struct __time_server_t {
     /** Settings and callbacks for this instance. */
     time_server_settings_t settings;
 
+    /** Callbacks of this instance, see time_server_set_callbacks() */
+    time_server_callbacks_t callbacks;
+
     /** Time server state */
     time_server_state_t server_state;
     
-    /** State handle for this instance and the coexisting time_setup_server instance */
-    uint8_t flash_state_handle;
+#if TIME_MODEL_PERSISTENCE
+    /** Journal the state of this instance and the coexisting time_setup_server instance is saved to, set before
+     *  time_setup_server_init() to restore the state from it, or NULL not to save the state */
+    time_model_journal_t * p_journal;
+
+    /** Time the state was last saved with */
+    uint64_t save_time;
+#endif
+
+#if TIME_MODEL_WARM_START
+    /** Reads the counter running through resets, see TIME_MODEL_WARM_START, set before time_setup_server_init() */
+    uint32_t (*retained_counter_get)(void);
+#endif
+
+    /** Time the time state was last synced to from a received Time Status message, or set to */
+    uint64_t last_sync_time;
+
+    /** Pending Time Zone / TAI-UTC Delta changes, sorted by the time at which they happen */
+    time_change_t pending_changes[TIME_CHANGE_TYPE_COUNT];
+    uint8_t pending_change_count;
+
+#if TIME_MODEL_USE_APP_TIMER
+    /** Next instance driven by the shared app timer, in the order of time_setup_server_init() calls */
+    time_server_t * p_next;
+
+    /** RTC counter value at which the timekeeping of this instance is next due, if timer_active */
+    uint32_t timer_deadline;
+    bool timer_active;
+#endif
+
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+    /** Status messages waiting for the end of the publication hold-off window */
+    uint8_t pending_publish;
+
+    /** RTC counter value at which the hold-off window ends, if pending_publish is not 0 */
+    uint32_t publish_deadline;
+#endif
+
+#if TIME_STATUS_DEDUP_CACHE_SIZE
+    /** Recently received Time Status messages */
+    time_status_dedup_entry_t dedup_cache[TIME_STATUS_DEDUP_CACHE_SIZE];
+
+    /** Number of received Time Status messages that were found in the cache and dropped, and that were not */
+    uint32_t dedup_hits;
+    uint32_t dedup_misses;
+#endif
+
+#if TIME_MODEL_TICKLESS
+    /** Time state at anchor_tick, in the fixed point format used internally for timekeeping */
+    uint64_t anchor_time;
+
+    /** RTC counter value at which the time state was last anchored */
+    uint32_t anchor_tick;
+#endif
+
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    /** Estimated rate correction of the local clock, in parts per billion */
+    int32_t drift_ppb;
+
+    /** Time of the sync the current frequency measurement started at, 0 if there is none */
+    uint64_t fll_interval_start;
+
+    /** Time of the last sync used by the frequency measurement */
+    uint64_t fll_last_sync;
+
+    /** Sum of the offsets corrected by syncs since fll_interval_start */
+    int64_t fll_offset_sum;
+
+    /** Estimated error remaining in drift_ppb, 0 until the first frequency measurement */
+    uint32_t fll_residual_ppb;
+#endif
+
+#if TIME_MODEL_UNCERTAINTY_GROWTH
+    /** Time at which the uncertainty state was last set */
+    uint64_t uncertainty_time;
+#endif
+
+#if TIME_MODEL_STATE_SNAPSHOT
+    /** Copies of the time state, written in turn, see TIME_MODEL_STATE_SNAPSHOT */
+    time_server_state_copy_t state_copies[2];
+
+    /** Incremented before writing each copy: odd while state_copies[0] is written, even while state_copies[1] is */
+    uint32_t state_seq;
+#endif
 };
 
 /**
- * Sets the callbacks of the model for the main application to receive events from the model
+ * Sets the callbacks of the model instance for the main application to receive events from it
  * 
- * @param[in]   p_callbacks     Pointer to a struct containing callbacks for the main application
+ * @param[in]   p_server        Server model context pointer
+ * @param[in]   p_callbacks     Pointer to a struct containing callbacks for the main application, copied into the instance
  * 
+ * @retval NRF_SUCCESS              The callbacks were set successfully.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
  */
-void time_server_set_callbacks(time_server_callbacks_t * p_callbacks);
+uint32_t time_server_set_callbacks(time_server_t * p_server, const time_server_callbacks_t * p_callbacks);
 
 /**
  * Publishes a Time Status message
@@ -321,6 +700,20 @@ uint32_t time_server_time_zone_status_publish(const time_server_t * p_server);
  */ 
 uint32_t time_server_tai_utc_delta_status_publish(const time_server_t * p_server);
 
+#if TIME_STATUS_DEDUP_CACHE_SIZE
+/**
+ * Gets the counters of the cache of recently received Time Status messages, to help sizing TIME_STATUS_DEDUP_CACHE_SIZE
+ * 
+ * @param[in]   p_server    Server model context pointer
+ * @param[out]  p_hits      Number of duplicate Time Status messages dropped
+ * @param[out]  p_misses    Number of Time Status messages not found in the cache
+ * 
+ * @retval NRF_SUCCESS              The counters were read successfully.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
+ */
+uint32_t time_server_dedup_stats_get(const time_server_t * p_server, uint32_t * p_hits, uint32_t * p_misses);
+#endif
+
 /********************************************************************* 
     TIME SETUP SERVER DEFINES
 **********************************************************************/
@@ -383,6 +776,9 @@ struct __time_setup_server_t {
 
     /** Model settings and callbacks for this instance */
     time_setup_server_settings_t settings;
+
+    /** Callbacks of this instance, see time_setup_server_set_callbacks() */
+    time_setup_server_callbacks_t callbacks;
 };
 
 /**
@@ -407,12 +803,16 @@ struct __time_setup_server_t {
 uint32_t time_setup_server_init(time_setup_server_t * p_s_server, uint8_t element_index);
 
 /**
- * Sets the callbacks of the model for the main application to receive events from the model
+ * Sets the callbacks of the model instance for the main application to receive events from it.
+ * The callbacks of its Time Server are set with time_server_set_callbacks()
  * 
- * @param[in]   p_callbacks     Pointer to a struct containing callbacks for the main application
+ * @param[in]   p_s_server      Time Setup Server model context pointer
+ * @param[in]   p_callbacks     Pointer to a struct containing callbacks for the main application, copied into the instance
  * 
+ * @retval NRF_SUCCESS              The callbacks were set successfully.
+ * @retval NRF_ERROR_NULL           NULL pointer given to function.
  */
-void time_setup_server_set_callbacks(time_setup_server_callbacks_t * p_callbacks);
+uint32_t time_setup_server_set_callbacks(time_setup_server_t * p_s_server, const time_setup_server_callbacks_t * p_callbacks);
 
 /**
  * Publishes a Time Role Status message
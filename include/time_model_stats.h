@@ -0,0 +1,177 @@
+/**
+ * MIT License
+ * Copyright (c) [2022] [Jefferson Zhai]
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef TIME_MODEL_STATS_H
+#define TIME_MODEL_STATS_H
+
+#include <stdint.h>
+
+/**
+ * @file time_model_stats.h
+ * @brief Instrumentation counters of the Time models
+ * @version 0.1
+ * 
+ * @details With TIME_MODEL_STATS enabled, the Time Server, Time Setup Server and Time Client count the
+ * messages they receive and send per opcode, tally the error codes of the failed sends, count the Time
+ * Status messages relayed by a TIME RELAY, and keep a histogram of how long each opcode handler ran.
+ * 
+ * The counters are shared by all the model instances and are only written from the mesh context. They
+ * are read with time_model_stats_snapshot().
+ * 
+ * With TIME_MODEL_STATS disabled (the default), none of this is compiled: the hooks expand to nothing,
+ * the handler tables point to the handlers directly and the snapshot API does not exist.
+ * 
+ */
+
+/** Enables the instrumentation counters. */
+#ifndef TIME_MODEL_STATS
+#define TIME_MODEL_STATS 0
+#endif
+
+/**
+ * Number of buckets of the handler latency histograms. Bucket 0 counts the handlers that ran in less
+ * than 1 us, bucket n the ones that ran in [2^(n-1), 2^n) us, and the last bucket everything above.
+ */
+#ifndef TIME_MODEL_STATS_LATENCY_BUCKETS
+#define TIME_MODEL_STATS_LATENCY_BUCKETS 16
+#endif
+
+/**
+ * Number of error codes tallied. Error code n (NRF_ERROR_BASE_NUM + n) is tallied in slot n, and the error
+ * codes from n = TIME_MODEL_STATS_ERROR_CODE_COUNT on in slot 0, which NRF_SUCCESS never takes.
+ */
+#ifndef TIME_MODEL_STATS_ERROR_CODE_COUNT
+#define TIME_MODEL_STATS_ERROR_CODE_COUNT 20
+#endif
+
+#if TIME_MODEL_STATS_LATENCY_BUCKETS < 2 || TIME_MODEL_STATS_LATENCY_BUCKETS > 33
+#error "TIME_MODEL_STATS_LATENCY_BUCKETS must be between 2 and 33"
+#endif
+
+#if TIME_MODEL_STATS_ERROR_CODE_COUNT < 1
+#error "TIME_MODEL_STATS_ERROR_CODE_COUNT must be at least 1"
+#endif
+
+#if TIME_MODEL_STATS
+
+/** Index of each Time model opcode in time_model_stats_t::opcodes */
+typedef enum {
+    TIME_MODEL_STATS_OPCODE_GET,
+    TIME_MODEL_STATS_OPCODE_SET,
+    TIME_MODEL_STATS_OPCODE_STATUS,
+    TIME_MODEL_STATS_OPCODE_ROLE_GET,
+    TIME_MODEL_STATS_OPCODE_ROLE_SET,
+    TIME_MODEL_STATS_OPCODE_ROLE_STATUS,
+    TIME_MODEL_STATS_OPCODE_ZONE_GET,
+    TIME_MODEL_STATS_OPCODE_ZONE_SET,
+    TIME_MODEL_STATS_OPCODE_ZONE_STATUS,
+    TIME_MODEL_STATS_OPCODE_TAI_UTC_DELTA_GET,
+    TIME_MODEL_STATS_OPCODE_TAI_UTC_DELTA_SET,
+    TIME_MODEL_STATS_OPCODE_TAI_UTC_DELTA_STATUS,
+    TIME_MODEL_STATS_OPCODE_COUNT
+} time_model_stats_opcode_t;
+
+/** Counters of one opcode */
+typedef struct {
+    /** Messages received, i.e. handler runs */
+    uint32_t rx_count;
+    /** Messages received and dropped for their length, see TIME_MODEL_OPCODE_HANDLER_DEFINE */
+    uint32_t rx_invalid_count;
+    /** Messages sent */
+    uint32_t tx_count;
+    /** Messages the access layer refused to send */
+    uint32_t tx_error_count;
+    /** Handler run times, see TIME_MODEL_STATS_LATENCY_BUCKETS */
+    uint32_t latency_histogram[TIME_MODEL_STATS_LATENCY_BUCKETS];
+} time_model_opcode_stats_t;
+
+typedef struct {
+    time_model_opcode_stats_t opcodes[TIME_MODEL_STATS_OPCODE_COUNT];
+    /** Failed sends per error code, see TIME_MODEL_STATS_ERROR_CODE_COUNT */
+    uint32_t error_counts[TIME_MODEL_STATS_ERROR_CODE_COUNT];
+    /** Time Status messages relayed by a TIME RELAY */
+    uint32_t relay_count;
+} time_model_stats_t;
+
+/**
+ * @brief Returns the index of an opcode in time_model_stats_t::opcodes
+ * 
+ * @param[in] opcode    Time model opcode
+ * 
+ * @return Index of the opcode, or TIME_MODEL_STATS_OPCODE_COUNT if it is not a Time model opcode
+ */
+time_model_stats_opcode_t time_model_stats_opcode_index(uint16_t opcode);
+
+/** Counts a received message and the run time of its handler */
+void time_model_stats_rx(uint16_t opcode, uint32_t latency_us);
+
+/** Counts a received message dropped for its length */
+void time_model_stats_rx_invalid(uint16_t opcode);
+
+/** Counts a message sent, or the error code of a failed send */
+void time_model_stats_tx(uint16_t opcode, uint32_t status);
+
+/** Counts a relayed Time Status message */
+void time_model_stats_relay(void);
+
+/**
+ * @brief Copies the counters
+ * 
+ * @note Each counter is copied whole, but a message handled while copying may be counted in some of
+ * the counters and not yet in others. Take the snapshot from the mesh context for an exact one.
+ * 
+ * @param[out] p_snapshot   Copy of the counters
+ */
+void time_model_stats_snapshot(time_model_stats_t * p_snapshot);
+
+/** Clears all the counters */
+void time_model_stats_reset(void);
+
+/**
+ * Defines handler##_stats, which runs an opcode handler and counts it, timed with timer_now(). Used in
+ * the model sources, after the handler and with access.h and timer.h included.
+ */
+#define TIME_MODEL_STATS_HANDLER_DEFINE(handler)                                                    \
+    static void handler##_stats(access_model_handle_t model_handle,                                 \
+                                const access_message_rx_t * p_rx_msg, void * p_args) {              \
+        timestamp_t start = timer_now();                                                            \
+        handler(model_handle, p_rx_msg, p_args);                                                    \
+        time_model_stats_rx(p_rx_msg->opcode.opcode, timer_now() - start);                          \
+    }
+
+/** Handler to put in an opcode handler table for handler */
+#define TIME_MODEL_STATS_HANDLER(handler) handler##_stats
+
+#define TIME_MODEL_STATS_RX_INVALID(opcode) time_model_stats_rx_invalid(opcode)
+#define TIME_MODEL_STATS_TX(opcode, status) time_model_stats_tx((opcode), (status))
+#define TIME_MODEL_STATS_RELAY() time_model_stats_relay()
+
+#else
+
+#define TIME_MODEL_STATS_HANDLER_DEFINE(handler)
+#define TIME_MODEL_STATS_HANDLER(handler) handler
+#define TIME_MODEL_STATS_RX_INVALID(opcode) ((void) 0)
+#define TIME_MODEL_STATS_TX(opcode, status) ((void) 0)
+#define TIME_MODEL_STATS_RELAY() ((void) 0)
+
+#endif
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * MIT License
+ * Copyright (c) [2022] [Jefferson Zhai]
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+*/
+#ifndef TIME_MODEL_TRACE_H
+#define TIME_MODEL_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file time_model_trace.h
+ * @brief Trace of the Time Server events
+ * @version 0.1
+ * 
+ * @details With TIME_MODEL_TRACE enabled, the Time Server records the events that change its time in a
+ * ring of TIME_MODEL_TRACE_SIZE records in RAM: the Time Status messages it receives, the Time Set and
+ * Time Role Set messages, the Time Zone and TAI-UTC Delta changes it applies and its tickless wakeups or late
+ * ticks. The ring keeps the last records, and time_model_trace_drain() takes them out of it.
+ * 
+ * Recording is wait-free: a record is written to the next slot, then published by moving the head. There
+ * is a single producer, so all the events must be recorded from the same context, which holds as long as
+ * the app_timer interrupt does not preempt the mesh (and the other way around). The drain may run from any
+ * other context, and drops the records that were overwritten while it read them.
+ * 
+ * time_model_trace_record_format() turns a record into text. It has no dependency on the mesh stack, so
+ * that it can also decode the records on a host, e.g. from a RAM dump.
+ * 
+ */
+
+/** Enables the trace. */
+#ifndef TIME_MODEL_TRACE
+#define TIME_MODEL_TRACE 0
+#endif
+
+/** Number of records kept in the trace. Must be a power of 2 */
+#ifndef TIME_MODEL_TRACE_SIZE
+#define TIME_MODEL_TRACE_SIZE 64
+#endif
+
+#if TIME_MODEL_TRACE_SIZE < 2 || (TIME_MODEL_TRACE_SIZE & (TIME_MODEL_TRACE_SIZE - 1)) != 0
+#error "TIME_MODEL_TRACE_SIZE must be a power of 2"
+#endif
+
+/** Source address of the events not caused by a message */
+#define TIME_MODEL_TRACE_SRC_LOCAL (0x0000)
+
+/** Trace events. The TAI times are the low 32 bits of the TAI seconds, which hold them until 2136 */
+typedef enum {
+    /** Time Status not synced to. Old: local TAI time, new: received TAI time, detail: received uncertainty */
+    TIME_MODEL_TRACE_TIME_STATUS,
+    /** Time Status synced to. Values and detail as TIME_MODEL_TRACE_TIME_STATUS */
+    TIME_MODEL_TRACE_TIME_STATUS_SYNC,
+    /** Time Set. Old: local TAI time, new: set TAI time, detail: set uncertainty */
+    TIME_MODEL_TRACE_TIME_SET,
+    /** Time Role Set. Old and new Time Role */
+    TIME_MODEL_TRACE_ROLE_SET,
+    /** Pending change applied. Old and new value, detail: time_change_type_t */
+    TIME_MODEL_TRACE_TIME_CHANGE,
+    /** Tickless wakeup, or 1 second tick handled too late for the next one. Old and new TAI time */
+    TIME_MODEL_TRACE_TIMER,
+    TIME_MODEL_TRACE_EVENT_COUNT
+} time_model_trace_event_t;
+
+/** Trace record */
+typedef struct {
+    /** timer_now() of the event, in microseconds */
+    uint32_t timestamp;
+    /** time_model_trace_event_t */
+    uint8_t event;
+    /** Event specific, see time_model_trace_event_t */
+    uint8_t detail;
+    /** Source address of the message, or TIME_MODEL_TRACE_SRC_LOCAL */
+    uint16_t src;
+    uint32_t old_value;
+    uint32_t new_value;
+} time_model_trace_record_t;
+
+/**
+ * @brief Returns the name of a trace event
+ * 
+ * @param[in] event   time_model_trace_event_t
+ * 
+ * @return Name of the event, or "UNKNOWN"
+ */
+const char * time_model_trace_event_name(uint8_t event);
+
+/**
+ * @brief Formats a trace record as one line of text, without the line break
+ * 
+ * @param[in] p_record    Record to format
+ * @param[out] p_buffer   Buffer for the text
+ * @param[in] size        Size of the buffer
+ * 
+ * @return Length of the whole text, as snprintf()
+ */
+int time_model_trace_record_format(const time_model_trace_record_t * p_record, char * p_buffer, size_t size);
+
+#if TIME_MODEL_TRACE
+
+/** Records an event. Only called from a single context, see the file description */
+void time_model_trace_record(uint8_t event, uint8_t detail, uint16_t src, uint32_t old_value, uint32_t new_value);
+
+/**
+ * @brief Takes the oldest records out of the trace
+ * 
+ * @param[out] p_records  Buffer for the records, oldest first
+ * @param[in] max_count   Size of the buffer in records
+ * @param[out] p_lost     Number of records overwritten before they could be drained since the previous
+ *                        drain. Can be NULL
+ * 
+ * @return Number of records taken
+ */
+uint32_t time_model_trace_drain(time_model_trace_record_t * p_records, uint32_t max_count, uint32_t * p_lost);
+
+#define TIME_MODEL_TRACE_RECORD(event, detail, src, old_value, new_value) \
+    time_model_trace_record((event), (detail), (src), (uint32_t) (old_value), (uint32_t) (new_value))
+
+#else
+
+#define TIME_MODEL_TRACE_RECORD(event, detail, src, old_value, new_value)
+
+#endif
+
+#endif
@@ -0,0 +1,149 @@
+#include "time_model_calendar.h"
+#include "time_model_common.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SECONDS_PER_DAY (86400)
+
+/** Days from 0000-03-01, the start of the 400 year cycle the computations are based on, to 2000-01-01 */
+#define DAYS_0000_03_01_TO_EPOCH (730425)
+
+/** Days in a 400 year cycle */
+#define DAYS_PER_ERA (146097)
+
+/** 
+ * Days added to the local time before dividing it into days, so that the division does not need to
+ * round negative times down. The local time can be up to the largest TAI-UTC Delta and Time Zone Offset
+ * before the epoch
+ */
+#define DAY_BIAS (2)
+
+/** 2000-01-01 was a Saturday */
+#define EPOCH_WEEKDAY (6)
+
+/** TAI times at which the TAI-UTC Delta changed since the TAI epoch, at the end of each leap second */
+static const struct {
+    uint64_t tai_seconds;
+    int32_t tai_utc_delta;
+} m_leap_seconds[] = {
+    {189388833, 33}, /* 2006-01-01 */
+    {284083234, 34}, /* 2009-01-01 */
+    {394416035, 35}, /* 2012-07-01 */
+    {489024036, 36}, /* 2015-07-01 */
+    {536544037, 37}, /* 2017-01-01 */
+};
+
+/** 
+ * Computes a date from the days since 0000-03-01. Counting the years from March puts the leap day
+ * at their end, so that the month and day follow from the day of the year with a linear formula
+ */
+static inline void date_from_days(uint32_t days, int32_t * p_year, uint32_t * p_month, uint32_t * p_day) {
+    uint32_t era = days / DAYS_PER_ERA;
+    uint32_t day_of_era = days - era * DAYS_PER_ERA;
+    uint32_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    uint32_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    uint32_t month_from_march = (5 * day_of_year + 2) / 153;
+    uint32_t month = month_from_march + 3 - 12 * (month_from_march >= 10);
+
+    *p_day = day_of_year - (153 * month_from_march + 2) / 5 + 1;
+    *p_month = month;
+    *p_year = (int32_t) (year_of_era + era * 400 + (month <= 2));
+}
+
+static void civil_from_local(int64_t local_seconds, time_model_civil_t * p_civil) {
+    uint64_t biased = (uint64_t) (local_seconds + (int64_t) DAY_BIAS * SECONDS_PER_DAY);
+    uint32_t second_of_day = (uint32_t) (biased % SECONDS_PER_DAY);
+
+    time_model_civil_from_days((int32_t) (biased / SECONDS_PER_DAY) - DAY_BIAS, p_civil);
+    p_civil->hour = (uint8_t) (second_of_day / 3600);
+    p_civil->minute = (uint8_t) (second_of_day / 60 % 60);
+    p_civil->second = (uint8_t) (second_of_day % 60);
+}
+
+int32_t time_model_days_from_civil(int32_t year, uint32_t month, uint32_t day) {
+    uint32_t year_from_march = (uint32_t) year - (month <= 2);
+    uint32_t era = year_from_march / 400;
+    uint32_t year_of_era = year_from_march - era * 400;
+    uint32_t day_of_year = (153 * ((month + 9) % 12) + 2) / 5 + day - 1;
+    uint32_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+    return (int32_t) (era * DAYS_PER_ERA + day_of_era) - DAYS_0000_03_01_TO_EPOCH;
+}
+
+void time_model_civil_from_days(int32_t days, time_model_civil_t * p_civil) {
+    uint32_t days_since_0000 = (uint32_t) (days + DAYS_0000_03_01_TO_EPOCH);
+    int32_t year;
+    uint32_t month;
+    uint32_t day;
+
+    date_from_days(days_since_0000, &year, &month, &day);
+    p_civil->year = year;
+    p_civil->month = (uint8_t) month;
+    p_civil->day = (uint8_t) day;
+    p_civil->weekday = (uint8_t) ((uint32_t) (days + DAY_BIAS * 7 + EPOCH_WEEKDAY) % 7);
+}
+
+void time_model_tai_to_civil(uint64_t tai_seconds, int32_t tai_utc_delta, int16_t time_zone_offset,
+                             time_model_civil_t * p_civil) {
+    civil_from_local(time_model_tai_to_local(tai_seconds, tai_utc_delta, time_zone_offset), p_civil);
+}
+
+uint64_t time_model_civil_to_tai(const time_model_civil_t * p_civil, int32_t tai_utc_delta, int16_t time_zone_offset) {
+    int64_t local_seconds = (int64_t) time_model_days_from_civil(p_civil->year, p_civil->month, p_civil->day) * SECONDS_PER_DAY +
+                            p_civil->hour * 3600 + p_civil->minute * 60 + p_civil->second;
+    int64_t tai_seconds = local_seconds - (int64_t) time_zone_offset * TIME_ZONE_OFFSET_STEP_SECONDS + tai_utc_delta;
+
+    return (tai_seconds < 0) ? TAI_TIME_UNKNOWN : (uint64_t) tai_seconds;
+}
+
+int32_t time_model_leap_tai_utc_delta_get(uint64_t tai_seconds) {
+    int32_t tai_utc_delta = TAI_UTC_DELTA_AT_EPOCH;
+
+    for (size_t i = 0; i < sizeof(m_leap_seconds) / sizeof(m_leap_seconds[0]); i++) {
+        tai_utc_delta = (tai_seconds >= m_leap_seconds[i].tai_seconds) ? m_leap_seconds[i].tai_utc_delta : tai_utc_delta;
+    }
+    return tai_utc_delta;
+}
+
+void time_model_tai_to_civil_leap(uint64_t tai_seconds, int16_t time_zone_offset, time_model_civil_t * p_civil) {
+    int32_t tai_utc_delta = time_model_leap_tai_utc_delta_get(tai_seconds);
+
+    /* The leap second is the last second before the TAI-UTC Delta changes */
+    if (time_model_leap_tai_utc_delta_get(tai_seconds + 1) != tai_utc_delta) {
+        civil_from_local(time_model_tai_to_local(tai_seconds - 1, tai_utc_delta, time_zone_offset), p_civil);
+        p_civil->second = 60;
+    } else {
+        civil_from_local(time_model_tai_to_local(tai_seconds, tai_utc_delta, time_zone_offset), p_civil);
+    }
+}
+
+void time_model_tai_to_local_batch(const uint64_t * p_tai_seconds, int64_t * p_local_seconds, size_t count,
+                                   int32_t tai_utc_delta, int16_t time_zone_offset) {
+    int64_t shift = (int64_t) time_zone_offset * TIME_ZONE_OFFSET_STEP_SECONDS - tai_utc_delta;
+
+    for (size_t i = 0; i < count; i++) {
+        p_local_seconds[i] = (int64_t) p_tai_seconds[i] + shift;
+    }
+}
+
+void time_model_tai_to_civil_batch(const uint64_t * p_tai_seconds, size_t count,
+                                   int32_t tai_utc_delta, int16_t time_zone_offset,
+                                   int32_t * p_year, uint8_t * p_month, uint8_t * p_day,
+                                   uint32_t * p_second_of_day) {
+    /* Shifting to the biased local time and to the days since 0000-03-01 at once keeps the loop unsigned */
+    uint64_t shift = (uint64_t) ((int64_t) time_zone_offset * TIME_ZONE_OFFSET_STEP_SECONDS - tai_utc_delta +
+                                 (int64_t) DAY_BIAS * SECONDS_PER_DAY);
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t biased = p_tai_seconds[i] + shift;
+        uint32_t days = (uint32_t) (biased / SECONDS_PER_DAY) - DAY_BIAS + DAYS_0000_03_01_TO_EPOCH;
+        uint32_t month;
+        uint32_t day;
+
+        date_from_days(days, &p_year[i], &month, &day);
+        p_month[i] = (uint8_t) month;
+        p_day[i] = (uint8_t) day;
+        p_second_of_day[i] = (uint32_t) (biased % SECONDS_PER_DAY);
+    }
+}
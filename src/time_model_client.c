@@ -1,5 +1,6 @@
 #include "time_model_client.h"
 #include "time_model_common.h"
+#include "time_model_stats.h"
 
 #include <stdint.h>
 #include <string.h>
@@ -7,46 +8,253 @@
 #include "access.h"
 #include "access_config.h"
 
-static time_client_callbacks_t time_client_callbacks = {0};
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+#include "device_state_manager.h"
+#endif
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE || TIME_CLIENT_FLEET_TABLE_SIZE || TIME_MODEL_STATS
+#include "timer.h"
+#include "timer_scheduler.h"
+#endif
+
+#if TIME_CLIENT_FLEET_TABLE_SIZE
+#define FLEET_INDEX_SIZE (TIME_CLIENT_FLEET_TABLE_SIZE * 2)
+#define FLEET_INDEX_EMPTY (0xFFFF)
+
+/** Period of the extension of the local time, a quarter of a wrap of timer_now() */
+#define FLEET_TIMER_INTERVAL_US (0x40000000UL)
+
+/** Finds the index slot of a node, or the empty slot it would take. The load factor of 1/2 keeps the probing short */
+static uint32_t fleet_slot_find(const time_client_t * p_client, uint16_t src) {
+    /* Unicast addresses are mostly allocated consecutively, which the low bits alone spread well */
+    uint32_t slot = src & (FLEET_INDEX_SIZE - 1);
+
+    while (p_client->fleet_index[slot] != FLEET_INDEX_EMPTY &&
+           p_client->fleet[p_client->fleet_index[slot]].src != src) {
+        slot = (slot + 1) & (FLEET_INDEX_SIZE - 1);
+    }
+    return slot;
+}
+
+static uint64_t fleet_local_time_get(time_client_t * p_client) {
+    timestamp_t now = timer_now();
+    p_client->fleet_local_time_us += (uint32_t) (now - p_client->fleet_local_timestamp);
+    p_client->fleet_local_timestamp = now;
+    return p_client->fleet_local_time_us;
+}
+
+static void fleet_timer_cb(timestamp_t timestamp, void * p_context) {
+    (void) fleet_local_time_get((time_client_t *) p_context);
+}
+
+/**
+ * Measures a skew sample between the reference sample of the entry and the new one, once they are
+ * at least TIME_CLIENT_FLEET_SKEW_MIN_INTERVAL_S apart, and folds it into the skew estimate
+ */
+static void fleet_skew_update(time_client_fleet_entry_t * p_entry, uint64_t rx_time_us, uint64_t time_us) {
+    if (p_entry->skew_ref_time_us == 0) {
+        p_entry->skew_ref_rx_time_us = rx_time_us;
+        p_entry->skew_ref_time_us = time_us;
+        return;
+    }
+
+    uint64_t interval_us = rx_time_us - p_entry->skew_ref_rx_time_us;
+    if (interval_us < (uint64_t) TIME_CLIENT_FLEET_SKEW_MIN_INTERVAL_S * 1000000) {
+        return;
+    }
+
+    int64_t drift_us = (int64_t) (time_us - p_entry->skew_ref_time_us) - (int64_t) interval_us;
+    p_entry->skew_ref_rx_time_us = rx_time_us;
+    p_entry->skew_ref_time_us = time_us;
+
+    int64_t max_drift_us = (int64_t) (interval_us / 1000000 * TIME_CLIENT_FLEET_MAX_SKEW_PPM);
+    if (drift_us > max_drift_us || drift_us < -max_drift_us) {
+        p_entry->skew_valid = false;
+        return;
+    }
+
+    int32_t sample_ppb = (int32_t) (drift_us * 1000000000 / (int64_t) interval_us);
+    if (p_entry->skew_valid) {
+        p_entry->skew_ppb += (sample_ppb - p_entry->skew_ppb) / (1 << TIME_CLIENT_FLEET_SKEW_EWMA_SHIFT);
+    } else {
+        p_entry->skew_ppb = sample_ppb;
+        p_entry->skew_valid = true;
+    }
+}
+
+static void fleet_update(time_client_t * p_client, uint16_t src, const time_status_params_t * p_in) {
+    uint64_t rx_time_us = fleet_local_time_get(p_client);
+    uint32_t slot = fleet_slot_find(p_client, src);
+    time_client_fleet_entry_t * p_entry;
+
+    if (p_client->fleet_index[slot] == FLEET_INDEX_EMPTY) {
+        if (p_client->fleet_count == TIME_CLIENT_FLEET_TABLE_SIZE) {
+            p_client->fleet_dropped++;
+            return;
+        }
+
+        p_client->fleet_index[slot] = p_client->fleet_count;
+        p_entry = &p_client->fleet[p_client->fleet_count++];
+        memset(p_entry, 0, sizeof(time_client_fleet_entry_t));
+        p_entry->src = src;
+    } else {
+        p_entry = &p_client->fleet[p_client->fleet_index[slot]];
+    }
+
+    p_entry->tai_seconds = p_in->tai_seconds;
+    p_entry->subsecond = p_in->subsecond;
+    p_entry->uncertainty = p_in->uncertainty;
+    p_entry->time_authority = p_in->time_authority;
+    p_entry->rx_time_us = rx_time_us;
+    p_entry->status_count++;
+
+    if (p_in->tai_seconds == TAI_TIME_UNKNOWN) {
+        p_entry->time_base_us = 0;
+        p_entry->skew_ref_time_us = 0;
+        p_entry->skew_valid = false;
+        return;
+    }
+
+    uint64_t time_us = p_in->tai_seconds * 1000000 + (((uint32_t) p_in->subsecond * 1000000) >> 8);
+    p_entry->time_base_us = (int64_t) (time_us - rx_time_us);
+    fleet_skew_update(p_entry, rx_time_us, time_us);
+}
+#endif
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+static void requests_dispatch(time_client_t * p_client);
+static void request_end(time_client_t * p_client, uint8_t index, uint32_t status, const time_status_params_t * p_in);
+#endif
+
+#if TIME_CLIENT_SWEEP
+static void sweep_fill(time_client_t * p_client);
+#endif
 
 static void handle_time_status(access_model_handle_t model_handle, 
                                const access_message_rx_t * p_rx_msg, 
                                void * p_args) {
     time_client_t * p_client = (time_client_t *) p_args;
     
-    time_status_msg_pkt_t * p_msg_in = (time_status_msg_pkt_t *) p_rx_msg->p_data;
+    /* The fields after the TAI seconds are left out when, and only when, the time is unknown, Section 5.2.1.3 */
+    time_status_msg_pkt_t msg_in;
+    time_status_msg_decode(p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    if (p_rx_msg->length < TIME_STATUS_MAXLEN && msg_in.tai_seconds != TAI_TIME_UNKNOWN) {
+        return;
+    }
+    const time_status_msg_pkt_t * p_msg_in = &msg_in;
+
+    time_status_params_t in_data;
+    in_data.tai_seconds = p_msg_in->tai_seconds;
+    in_data.subsecond = p_msg_in->subsecond;
+    in_data.uncertainty = p_msg_in->uncertainty;
+    in_data.time_authority = p_msg_in->time_authority;
+    in_data.time_zone_offset = time_zone_offset_decode(p_msg_in->time_zone_offset);
+    in_data.tai_utc_delta = tai_utc_delta_decode(p_msg_in->tai_utc_delta);
+
+#if TIME_CLIENT_FLEET_TABLE_SIZE
+    fleet_update(p_client, p_rx_msg->meta_data.src.value, &in_data);
+#endif
 	
-    if (time_client_callbacks.time_status_cb != NULL) {
-	time_status_params_t in_data;
-	in_data.tai_seconds = p_msg_in->tai_seconds;
-	in_data.subsecond = p_msg_in->subsecond;
-	in_data.uncertainty = p_msg_in->uncertainty;
-	in_data.time_zone_offset = time_zone_offset_decode(p_msg_in->time_zone_offset);
-	in_data.tai_utc_delta = tai_utc_delta_decode(p_msg_in->tai_utc_delta);
-	    
-	time_client_callbacks.time_status_cb(p_client, &p_rx_msg->meta_data, &in_data);
+    if (p_client->callbacks.time_status_cb != NULL) {
+	p_client->callbacks.time_status_cb(p_client, &p_rx_msg->meta_data, &in_data);
+    }
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+    /* Any Time Status from the destination of a request in flight answers it */
+    for (uint8_t i = 0; i < p_client->in_flight_count; i++) {
+        if (p_client->in_flight[i].dst == p_rx_msg->meta_data.src.value) {
+            request_end(p_client, i, NRF_SUCCESS, &in_data);
+            requests_dispatch(p_client);
+            break;
+        }
     }
+#endif
 }
 
+static void handle_time_zone_status(access_model_handle_t model_handle, 
+                                    const access_message_rx_t * p_rx_msg, 
+                                    void * p_args) {
+    time_client_t * p_client = (time_client_t *) p_args;
+
+    time_zone_status_msg_pkt_t msg_in;
+    time_model_msg_decode(&time_zone_status_msg_format, p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    const time_zone_status_msg_pkt_t * p_msg_in = &msg_in;
+
+    if (p_client->callbacks.time_zone_status_cb != NULL) {
+	time_zone_status_params_t in_data;
+	in_data.time_zone_offset_current = time_zone_offset_decode(p_msg_in->time_zone_offset_current);
+	in_data.time_zone_offset_new = time_zone_offset_decode(p_msg_in->time_zone_offset_new);
+	in_data.time_zone_change = p_msg_in->time_zone_change;
+
+	p_client->callbacks.time_zone_status_cb(p_client, &p_rx_msg->meta_data, &in_data);
+    }
+}
+
+static void handle_tai_utc_delta_status(access_model_handle_t model_handle, 
+                                        const access_message_rx_t * p_rx_msg, 
+                                        void * p_args) {
+    time_client_t * p_client = (time_client_t *) p_args;
+
+    tai_utc_delta_status_msg_pkt_t msg_in;
+    time_model_msg_decode(&tai_utc_delta_status_msg_format, p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    const tai_utc_delta_status_msg_pkt_t * p_msg_in = &msg_in;
+
+    if (p_client->callbacks.tai_utc_delta_status_cb != NULL) {
+	tai_utc_delta_status_params_t in_data;
+	in_data.tai_utc_delta_current = tai_utc_delta_decode(p_msg_in->tai_utc_delta_current);
+	in_data.tai_utc_delta_new = tai_utc_delta_decode(p_msg_in->tai_utc_delta_new);
+	in_data.tai_utc_delta_change = p_msg_in->tai_utc_delta_change;
+
+	p_client->callbacks.tai_utc_delta_status_cb(p_client, &p_rx_msg->meta_data, &in_data);
+    }
+}
+
+static void handle_time_role_status(access_model_handle_t model_handle, 
+                                    const access_message_rx_t * p_rx_msg, 
+                                    void * p_args) {
+    time_client_t * p_client = (time_client_t *) p_args;
+
+    time_role_status_msg_pkt_t msg_in;
+    time_model_msg_decode(&time_role_status_msg_format, p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    const time_role_status_msg_pkt_t * p_msg_in = &msg_in;
+
+    if (p_client->callbacks.time_role_status_cb != NULL) {
+	time_role_status_params_t in_data = {
+	    .time_role = (time_role_t) p_msg_in->time_role
+	};
+
+	p_client->callbacks.time_role_status_cb(p_client, &p_rx_msg->meta_data, &in_data);
+    }
+}
+
+/** Messages handled by the Time Client, with their minimum and maximum payload lengths */
+#define TIME_CLIENT_OPCODES(X)                                                                                        \
+    X(TIME_OPCODE_STATUS, handle_time_status, TIME_STATUS_MINLEN, TIME_STATUS_MAXLEN)                                \
+    X(TIME_OPCODE_ZONE_STATUS, handle_time_zone_status, TIME_ZONE_STATUS_LEN, TIME_ZONE_STATUS_LEN)                   \
+    X(TIME_OPCODE_TAI_UTC_DELTA_STATUS, handle_tai_utc_delta_status, TAI_UTC_DELTA_STATUS_LEN, TAI_UTC_DELTA_STATUS_LEN) \
+    X(TIME_OPCODE_ROLE_STATUS, handle_time_role_status, TIME_ROLE_STATUS_LEN, TIME_ROLE_STATUS_LEN)
+
+TIME_CLIENT_OPCODES(TIME_MODEL_OPCODE_HANDLER_DEFINE)
+
 static const access_opcode_handler_t m_opcode_handlers[] = {
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_STATUS), handle_time_status},
+    TIME_CLIENT_OPCODES(TIME_MODEL_OPCODE_TABLE_ENTRY)
 };
 
 static void periodic_publish_client_cb(access_model_handle_t handle, void * p_args) {
     time_client_t * p_client = (time_client_t *) p_args;
-    
-    if (time_client_callbacks.periodic_publish_cb != NULL) {
-	    time_client_callbacks.periodic_publish_cb(handle, p_args);
+
+    if (p_client->callbacks.periodic_publish_cb != NULL) {
+	    p_client->callbacks.periodic_publish_cb(handle, p_args);
     }
 }
 
 static void transaction_status(access_model_handle_t model_handle, 
-                               access_reliable_status_t status, 
-                               void * p_args) {
+                               void * p_args, 
+                               access_reliable_status_t status) {
     time_client_t * p_client = (time_client_t *) p_args;
-    
-    if (time_client_callbacks.ack_transaction_status_cb != NULL) {
-	    time_client_callbacks.ack_transaction_status_cb(model_handle, p_args, status);
+
+    if (p_client->callbacks.ack_transaction_status_cb != NULL) {
+	    p_client->callbacks.ack_transaction_status_cb(model_handle, p_args, status);
     }
 	
 }
@@ -71,6 +279,336 @@ static void reliable_context_create(time_client_t * p_client, uint16_t reply_opc
     p_reliable->status_cb = transaction_status;
 }
 
+/** The Set messages are encoded straight from their parameters into the payload to send */
+static void time_set_encode(const time_set_params_t * p_params, uint8_t * p_buffer) {
+    time_set_msg_pkt_t msg_pkt = {
+        .tai_seconds = p_params->tai_seconds,
+        .subsecond = p_params->subsecond,
+        .uncertainty = p_params->uncertainty,
+        .time_authority = p_params->time_authority,
+        .tai_utc_delta = tai_utc_delta_encode(p_params->tai_utc_delta),
+        .time_zone_offset = time_zone_offset_encode(p_params->time_zone_offset)
+    };
+    (void) time_model_msg_encode(&time_set_msg_format, &msg_pkt, p_buffer);
+}
+
+static void time_zone_set_encode(const time_zone_set_params_t * p_params, uint8_t * p_buffer) {
+    time_zone_set_msg_pkt_t msg_pkt = {
+        .time_zone_offset_new = time_zone_offset_encode(p_params->time_zone_offset_new),
+        .time_zone_change = p_params->time_zone_change
+    };
+    (void) time_model_msg_encode(&time_zone_set_msg_format, &msg_pkt, p_buffer);
+}
+
+static void tai_utc_delta_set_encode(const tai_utc_delta_set_params_t * p_params, uint8_t * p_buffer) {
+    tai_utc_delta_set_msg_pkt_t msg_pkt = {
+        .tai_utc_delta_new = tai_utc_delta_encode(p_params->tai_utc_delta_new),
+        .tai_utc_delta_change = p_params->tai_utc_delta_change
+    };
+    (void) time_model_msg_encode(&tai_utc_delta_set_msg_format, &msg_pkt, p_buffer);
+}
+
+static void time_role_set_encode(const time_role_set_params_t * p_params, uint8_t * p_buffer) {
+    time_role_set_msg_pkt_t msg_pkt = {
+        .time_role = (uint8_t) p_params->time_role
+    };
+    (void) time_model_msg_encode(&time_role_set_msg_format, &msg_pkt, p_buffer);
+}
+
+static bool time_set_params_validate(const time_set_params_t * p_params) {
+    return (validate_tai_time_arg(p_params->tai_seconds) &&
+            validate_tai_utc_delta_arg(p_params->tai_utc_delta) &&
+            validate_time_zone_offset_arg(p_params->time_zone_offset));
+}
+
+static bool time_zone_set_params_validate(const time_zone_set_params_t * p_params) {
+    return (validate_tai_time_arg(p_params->time_zone_change) &&
+            validate_time_zone_offset_arg(p_params->time_zone_offset_new));
+}
+
+static bool tai_utc_delta_set_params_validate(const tai_utc_delta_set_params_t * p_params) {
+    return (validate_tai_time_arg(p_params->tai_utc_delta_change) &&
+            validate_tai_utc_delta_arg(p_params->tai_utc_delta_new));
+}
+
+static bool time_role_set_params_validate(const time_role_set_params_t * p_params) {
+    return (p_params->time_role <= TIME_ROLE_CLIENT);
+}
+
+/** Starts an acknowledged transaction with the payload already encoded in p_client->msg_pkt */
+static uint32_t reliable_send(time_client_t * p_client, uint16_t tx_opcode, uint16_t reply_opcode, uint16_t length) {
+    message_create(p_client, tx_opcode, p_client->msg_pkt, length, &p_client->access_message.message);
+    reliable_context_create(p_client, reply_opcode, &p_client->access_message);
+
+    uint32_t status = access_model_reliable_publish(&p_client->access_message);
+    TIME_MODEL_STATS_TX(tx_opcode, status);
+    return status;
+}
+
+static uint32_t unack_send(time_client_t * p_client, uint16_t tx_opcode, const uint8_t * p_buffer, uint16_t length) {
+    access_message_tx_t message;
+    message_create(p_client, tx_opcode, p_buffer, length, &message);
+
+    uint32_t status = access_model_publish(p_client->model_handle, &message);
+    TIME_MODEL_STATS_TX(tx_opcode, status);
+    return status;
+}
+
+static uint32_t get_send(time_client_t * p_client, uint16_t tx_opcode, uint16_t reply_opcode) {
+    if (p_client == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (!access_reliable_model_is_free(p_client->model_handle)) {
+        return NRF_ERROR_BUSY;
+    }
+
+    return reliable_send(p_client, tx_opcode, reply_opcode, 0);
+}
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+/**
+ * Sends an unacknowledged Time Get to dst. It goes out like a reply to a message from dst, with the application
+ * key and TTL of the publication of the model, so that neither the publication configured for the model nor the
+ * publish addresses of the device state manager are touched, and any number of requests to different
+ * destinations can be in flight at once
+ */
+static uint32_t request_send(time_client_t * p_client, uint16_t dst) {
+    access_message_rx_t request = {
+        .meta_data.src.type = NRF_MESH_ADDRESS_TYPE_UNICAST,
+        .meta_data.src.value = dst
+    };
+
+    uint32_t status = access_model_publish_application_get(p_client->model_handle, &request.meta_data.appkey_handle);
+    if (status == NRF_SUCCESS && request.meta_data.appkey_handle == DSM_HANDLE_INVALID) {
+        status = NRF_ERROR_INVALID_STATE;
+    }
+    if (status == NRF_SUCCESS) {
+        status = dsm_appkey_handle_to_subnet_handle(request.meta_data.appkey_handle, &request.meta_data.subnet_handle);
+    }
+    if (status == NRF_SUCCESS) {
+        status = access_model_publish_ttl_get(p_client->model_handle, &request.meta_data.ttl);
+    }
+    if (status != NRF_SUCCESS) {
+        return status;
+    }
+
+    access_message_tx_t message;
+    message_create(p_client, TIME_OPCODE_GET, NULL, 0, &message);
+    status = access_model_reply(p_client->model_handle, &request, &message);
+    TIME_MODEL_STATS_TX(TIME_OPCODE_GET, status);
+    return status;
+}
+
+/** Arms the request timer for the earliest timeout in flight, or for a retry */
+static void request_timer_update(time_client_t * p_client, bool retry) {
+    timestamp_t now = timer_now();
+    bool armed = retry;
+    timestamp_t next = now + TIME_CLIENT_REQUEST_RETRY_DELAY_US;
+
+    for (uint8_t i = 0; i < p_client->in_flight_count; i++) {
+        if (!armed || (int32_t) (p_client->in_flight[i].deadline - next) < 0) {
+            next = p_client->in_flight[i].deadline;
+            armed = true;
+        }
+    }
+
+    if (armed) {
+        timer_sch_reschedule(&p_client->request_timer, next);
+    } else {
+        timer_sch_abort(&p_client->request_timer);
+    }
+}
+
+/** Removes a request from the ones in flight, and ends it */
+static void request_end(time_client_t * p_client, uint8_t index, uint32_t status, const time_status_params_t * p_in) {
+    time_client_request_t request = p_client->in_flight[index];
+
+    /* The order of the requests in flight does not matter, so the last one fills the gap */
+    p_client->in_flight[index] = p_client->in_flight[--p_client->in_flight_count];
+    request.cb(p_client, request.dst, status, p_in, request.p_context);
+}
+
+/**
+ * Sends queued requests in order while there is room in flight. Running out of buffers in the mesh
+ * stack only holds the queue back until a later retry, up to TIME_CLIENT_REQUEST_MAX_RETRIES times
+ * in a row, other send errors end the request. A sweep in progress then takes the room left
+ */
+static void requests_dispatch(time_client_t * p_client) {
+    bool retry = false;
+
+    while (p_client->pending_count > 0 && p_client->in_flight_count < p_client->settings.max_in_flight) {
+        time_client_request_t request = p_client->pending[p_client->pending_head];
+        uint32_t status = request_send(p_client, request.dst);
+        if (status == NRF_ERROR_NO_MEM && p_client->pending_retries < TIME_CLIENT_REQUEST_MAX_RETRIES) {
+            p_client->pending_retries++;
+            retry = true;
+            break;
+        }
+
+        p_client->pending_retries = 0;
+        p_client->pending_head = (p_client->pending_head + 1) % TIME_CLIENT_REQUEST_QUEUE_SIZE;
+        p_client->pending_count--;
+
+        if (status == NRF_SUCCESS) {
+            request.deadline = timer_now() + p_client->settings.timeout;
+            p_client->in_flight[p_client->in_flight_count++] = request;
+        } else {
+            request.cb(p_client, request.dst, status, NULL, request.p_context);
+        }
+    }
+
+    request_timer_update(p_client, retry);
+
+#if TIME_CLIENT_SWEEP
+    sweep_fill(p_client);
+#endif
+}
+
+static void request_timer_cb(timestamp_t timestamp, void * p_context) {
+    time_client_t * p_client = (time_client_t *) p_context;
+
+    uint8_t i = 0;
+    while (i < p_client->in_flight_count) {
+        if ((int32_t) (p_client->in_flight[i].deadline - timestamp) <= 0) {
+            /* The slot is refilled with another request in flight, so it is checked again */
+            request_end(p_client, i, NRF_ERROR_TIMEOUT, NULL);
+        } else {
+            i++;
+        }
+    }
+
+    requests_dispatch(p_client);
+}
+#endif
+
+#if TIME_CLIENT_SWEEP
+static void sweep_end(time_client_t * p_client, bool cancelled) {
+    time_client_sweep_t * p_sweep = &p_client->sweep;
+
+    p_sweep->active = false;
+    p_sweep->report.cancelled = cancelled;
+    p_client->settings.max_in_flight = p_sweep->saved_max_in_flight;
+    p_sweep->report.duration_us = timer_now() - p_sweep->start;
+    p_sweep->report.window = p_sweep->window;
+
+    if (p_sweep->done_cb != NULL) {
+        p_sweep->done_cb(p_client, &p_sweep->report);
+    }
+}
+
+/** Ends a request of the sweep, adapting the window: one more for each window of replies, half on a timeout */
+static void sweep_request_cb(const time_client_t * p_self, uint16_t dst, uint32_t status,
+                             const time_status_params_t * p_in, void * p_context) {
+    time_client_t * p_client = (time_client_t *) p_self;
+    time_client_sweep_t * p_sweep = &p_client->sweep;
+    uint32_t seq = (uint32_t) (uintptr_t) p_context;
+
+    /* Requests left over from a stopped sweep */
+    if (!p_sweep->active || (int32_t) (seq - p_sweep->base_seq) < 0) {
+        return;
+    }
+
+    p_sweep->outstanding--;
+    if (status == NRF_SUCCESS) {
+        p_sweep->report.reply_count++;
+        if (++p_sweep->window_credit >= p_sweep->window) {
+            p_sweep->window_credit = 0;
+            if (p_sweep->window < TIME_CLIENT_MAX_IN_FLIGHT) {
+                p_sweep->window++;
+            }
+        }
+    } else if (status == NRF_ERROR_TIMEOUT) {
+        p_sweep->report.timeout_count++;
+        /* The requests sent before the last decrease were already in flight when it was decided on */
+        if ((int32_t) (seq - p_sweep->decrease_seq) >= 0) {
+            p_sweep->window = (p_sweep->window > 1) ? (p_sweep->window / 2) : 1;
+            p_sweep->window_credit = 0;
+            p_sweep->decrease_seq = p_sweep->seq;
+        }
+    } else {
+        p_sweep->report.error_count++;
+    }
+
+    /* The room freed in the window is refilled by requests_dispatch() */
+    p_sweep->result_cb(p_self, dst, status, p_in, NULL);
+}
+
+/** Queues requests for the next addresses of the sweep while it has room in its window */
+static void sweep_fill(time_client_t * p_client) {
+    time_client_sweep_t * p_sweep = &p_client->sweep;
+
+    /* Requests can end from within time_client_time_get_queue(), e.g. on send errors. Their callbacks
+       then leave the refill to this loop, so that the stack does not grow by one call per address */
+    if (!p_sweep->active || p_sweep->filling) {
+        return;
+    }
+
+    p_sweep->filling = true;
+
+    /* The state is updated before queuing, and the loop checks whether the sweep is still active */
+    while (p_sweep->active && p_sweep->next < p_sweep->count && p_sweep->outstanding < p_sweep->window) {
+        p_client->settings.max_in_flight = p_sweep->window;
+
+        uint16_t index = p_sweep->next++;
+        uint16_t dst = (p_sweep->p_list != NULL) ? p_sweep->p_list[index] : (uint16_t) (p_sweep->first + index);
+        uint32_t seq = p_sweep->seq++;
+
+        p_sweep->outstanding++;
+        uint32_t status = time_client_time_get_queue(p_client, dst, sweep_request_cb, (void *) (uintptr_t) seq);
+        if (status == NRF_ERROR_NO_MEM) {
+            /* The queue is full, the sweep goes on once requests_dispatch() makes room in it */
+            p_sweep->next--;
+            p_sweep->outstanding--;
+            break;
+        } else if (status != NRF_SUCCESS) {
+            p_sweep->outstanding--;
+            p_sweep->report.error_count++;
+            p_sweep->result_cb(p_client, dst, status, NULL, NULL);
+        }
+    }
+
+    p_sweep->filling = false;
+    if (p_sweep->active) {
+        p_client->settings.max_in_flight = p_sweep->window;
+    }
+
+    if (p_sweep->active && p_sweep->next == p_sweep->count && p_sweep->outstanding == 0) {
+        sweep_end(p_client, false);
+    }
+}
+
+static uint32_t sweep_start(time_client_t * p_client, const uint16_t * p_list, uint16_t first, uint16_t count,
+                            time_client_request_cb_t result_cb, time_client_sweep_done_cb_t done_cb) {
+    time_client_sweep_t * p_sweep = &p_client->sweep;
+
+    if (p_sweep->active) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    p_sweep->p_list = p_list;
+    p_sweep->first = first;
+    p_sweep->count = count;
+    p_sweep->next = 0;
+    p_sweep->outstanding = 0;
+    p_sweep->window = TIME_CLIENT_SWEEP_INITIAL_WINDOW;
+    p_sweep->window_credit = 0;
+    p_sweep->saved_max_in_flight = p_client->settings.max_in_flight;
+    p_sweep->base_seq = p_sweep->seq;
+    p_sweep->decrease_seq = p_sweep->seq;
+    p_sweep->start = timer_now();
+    p_sweep->result_cb = result_cb;
+    p_sweep->done_cb = done_cb;
+    memset(&p_sweep->report, 0, sizeof(time_client_sweep_report_t));
+    p_sweep->report.node_count = count;
+    p_sweep->filling = false;
+    p_sweep->active = true;
+
+    sweep_fill(p_client);
+    return NRF_SUCCESS;
+}
+#endif
+
 /** Interface functions */
 uint32_t time_client_init(time_client_t * p_client, uint8_t element_index) {
     if (p_client == NULL) {
@@ -81,6 +619,28 @@ uint32_t time_client_init(time_client_t * p_client, uint8_t element_index) {
         p_client->settings.timeout = MODEL_ACKNOWLEDGED_TRANSACTION_TIMEOUT;
     }
 
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+    if (p_client->settings.max_in_flight == 0 || p_client->settings.max_in_flight > TIME_CLIENT_MAX_IN_FLIGHT) {
+        p_client->settings.max_in_flight = TIME_CLIENT_MAX_IN_FLIGHT;
+    }
+
+    p_client->pending_head = 0;
+    p_client->pending_count = 0;
+    p_client->pending_retries = 0;
+    p_client->in_flight_count = 0;
+    p_client->request_timer.cb = request_timer_cb;
+    p_client->request_timer.p_context = p_client;
+    p_client->request_timer.interval = 0;
+#endif
+
+#if TIME_CLIENT_SWEEP
+    memset(&p_client->sweep, 0, sizeof(time_client_sweep_t));
+#endif
+
+#if TIME_CLIENT_FLEET_TABLE_SIZE
+    time_client_fleet_clear(p_client);
+#endif
+
     access_model_add_params_t add_params = {
         .model_id = ACCESS_MODEL_SIG(TIME_CLIENT_MODEL_ID),
         .element_index = element_index,
@@ -96,25 +656,281 @@ uint32_t time_client_init(time_client_t * p_client, uint8_t element_index) {
         status = access_model_subscription_list_alloc(p_client->model_handle);
     }
 
+#if TIME_CLIENT_FLEET_TABLE_SIZE
+    if (status == NRF_SUCCESS) {
+        p_client->fleet_timer.cb = fleet_timer_cb;
+        p_client->fleet_timer.p_context = p_client;
+        p_client->fleet_timer.interval = FLEET_TIMER_INTERVAL_US;
+        p_client->fleet_timer.timestamp = timer_now() + FLEET_TIMER_INTERVAL_US;
+        timer_sch_schedule(&p_client->fleet_timer);
+    }
+#endif
+
     return status;
 }
 
-void time_client_set_callbacks(time_client_callbacks_t * p_callbacks) {
-    memcpy(&time_client_callbacks, p_callbacks, sizeof(time_client_callbacks_t));
+uint32_t time_client_set_callbacks(time_client_t * p_client, const time_client_callbacks_t * p_callbacks) {
+    if (p_client == NULL || p_callbacks == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    memcpy(&p_client->callbacks, p_callbacks, sizeof(time_client_callbacks_t));
+    return NRF_SUCCESS;
 }
 
 uint32_t time_client_time_get(time_client_t * p_client) {
-    if (p_client == NULL) {
+    return get_send(p_client, TIME_OPCODE_GET, TIME_OPCODE_STATUS);
+}
+
+uint32_t time_client_time_zone_get(time_client_t * p_client) {
+    return get_send(p_client, TIME_OPCODE_ZONE_GET, TIME_OPCODE_ZONE_STATUS);
+}
+
+uint32_t time_client_tai_utc_delta_get(time_client_t * p_client) {
+    return get_send(p_client, TIME_OPCODE_TAI_UTC_DELTA_GET, TIME_OPCODE_TAI_UTC_DELTA_STATUS);
+}
+
+uint32_t time_client_time_role_get(time_client_t * p_client) {
+    return get_send(p_client, TIME_OPCODE_ROLE_GET, TIME_OPCODE_ROLE_STATUS);
+}
+
+uint32_t time_client_time_set(time_client_t * p_client, const time_set_params_t * p_params) {
+    if (p_client == NULL || p_params == NULL) {
         return NRF_ERROR_NULL;
     }
 
-    if (access_reliable_model_is_free(p_client->model_handle)) {
-        message_create(p_client, TIME_OPCODE_GET, NULL, 0, &p_client->access_message.message);
-        reliable_context_create(p_client, TIME_OPCODE_STATUS, &p_client->access_message);
+    if (!time_set_params_validate(p_params)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (!access_reliable_model_is_free(p_client->model_handle)) {
+        return NRF_ERROR_BUSY;
+    }
+
+    time_set_encode(p_params, p_client->msg_pkt);
+    return reliable_send(p_client, TIME_OPCODE_SET, TIME_OPCODE_STATUS, TIME_SET_LEN);
+}
+
+uint32_t time_client_time_set_unack(time_client_t * p_client, const time_set_params_t * p_params) {
+    if (p_client == NULL || p_params == NULL) {
+        return NRF_ERROR_NULL;
+    }
 
-        return access_model_reliable_publish(&p_client->access_message);
+    if (!time_set_params_validate(p_params)) {
+        return NRF_ERROR_INVALID_PARAM;
     }
-    else {
+
+    uint8_t buffer[TIME_SET_LEN];
+    time_set_encode(p_params, buffer);
+    return unack_send(p_client, TIME_OPCODE_SET, buffer, TIME_SET_LEN);
+}
+
+uint32_t time_client_time_zone_set(time_client_t * p_client, const time_zone_set_params_t * p_params) {
+    if (p_client == NULL || p_params == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (!time_zone_set_params_validate(p_params)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (!access_reliable_model_is_free(p_client->model_handle)) {
         return NRF_ERROR_BUSY;
     }
-}
\ No newline at end of file
+
+    time_zone_set_encode(p_params, p_client->msg_pkt);
+    return reliable_send(p_client, TIME_OPCODE_ZONE_SET, TIME_OPCODE_ZONE_STATUS, TIME_ZONE_SET_LEN);
+}
+
+uint32_t time_client_time_zone_set_unack(time_client_t * p_client, const time_zone_set_params_t * p_params) {
+    if (p_client == NULL || p_params == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (!time_zone_set_params_validate(p_params)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t buffer[TIME_ZONE_SET_LEN];
+    time_zone_set_encode(p_params, buffer);
+    return unack_send(p_client, TIME_OPCODE_ZONE_SET, buffer, TIME_ZONE_SET_LEN);
+}
+
+uint32_t time_client_tai_utc_delta_set(time_client_t * p_client, const tai_utc_delta_set_params_t * p_params) {
+    if (p_client == NULL || p_params == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (!tai_utc_delta_set_params_validate(p_params)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (!access_reliable_model_is_free(p_client->model_handle)) {
+        return NRF_ERROR_BUSY;
+    }
+
+    tai_utc_delta_set_encode(p_params, p_client->msg_pkt);
+    return reliable_send(p_client, TIME_OPCODE_TAI_UTC_DELTA_SET, TIME_OPCODE_TAI_UTC_DELTA_STATUS, TAI_UTC_DELTA_SET_LEN);
+}
+
+uint32_t time_client_tai_utc_delta_set_unack(time_client_t * p_client, const tai_utc_delta_set_params_t * p_params) {
+    if (p_client == NULL || p_params == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (!tai_utc_delta_set_params_validate(p_params)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t buffer[TAI_UTC_DELTA_SET_LEN];
+    tai_utc_delta_set_encode(p_params, buffer);
+    return unack_send(p_client, TIME_OPCODE_TAI_UTC_DELTA_SET, buffer, TAI_UTC_DELTA_SET_LEN);
+}
+
+uint32_t time_client_time_role_set(time_client_t * p_client, const time_role_set_params_t * p_params) {
+    if (p_client == NULL || p_params == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (!time_role_set_params_validate(p_params)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if (!access_reliable_model_is_free(p_client->model_handle)) {
+        return NRF_ERROR_BUSY;
+    }
+
+    time_role_set_encode(p_params, p_client->msg_pkt);
+    return reliable_send(p_client, TIME_OPCODE_ROLE_SET, TIME_OPCODE_ROLE_STATUS, TIME_ROLE_SET_LEN);
+}
+
+uint32_t time_client_time_role_set_unack(time_client_t * p_client, const time_role_set_params_t * p_params) {
+    if (p_client == NULL || p_params == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (!time_role_set_params_validate(p_params)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    uint8_t buffer[TIME_ROLE_SET_LEN];
+    time_role_set_encode(p_params, buffer);
+    return unack_send(p_client, TIME_OPCODE_ROLE_SET, buffer, TIME_ROLE_SET_LEN);
+}
+
+#if TIME_CLIENT_REQUEST_QUEUE_SIZE
+uint32_t time_client_time_get_queue(time_client_t * p_client, uint16_t dst, time_client_request_cb_t cb, void * p_context) {
+    if (p_client == NULL || cb == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (nrf_mesh_address_type_get(dst) != NRF_MESH_ADDRESS_TYPE_UNICAST) {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    if (p_client->pending_count == TIME_CLIENT_REQUEST_QUEUE_SIZE) {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    uint16_t tail = (p_client->pending_head + p_client->pending_count) % TIME_CLIENT_REQUEST_QUEUE_SIZE;
+    p_client->pending[tail].dst = dst;
+    p_client->pending[tail].cb = cb;
+    p_client->pending[tail].p_context = p_context;
+    p_client->pending_count++;
+
+    requests_dispatch(p_client);
+    return NRF_SUCCESS;
+}
+
+void time_client_requests_cancel(time_client_t * p_client) {
+    if (p_client == NULL) {
+        return;
+    }
+
+#if TIME_CLIENT_SWEEP
+    /* The sweep would otherwise wait for its dropped requests forever */
+    time_client_sweep_stop(p_client);
+#endif
+    timer_sch_abort(&p_client->request_timer);
+    p_client->pending_count = 0;
+    p_client->pending_retries = 0;
+    p_client->in_flight_count = 0;
+}
+#endif
+
+#if TIME_CLIENT_SWEEP
+uint32_t time_client_sweep_range_start(time_client_t * p_client, uint16_t first, uint16_t last,
+                                       time_client_request_cb_t result_cb, time_client_sweep_done_cb_t done_cb) {
+    if (p_client == NULL || result_cb == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (last < first ||
+        nrf_mesh_address_type_get(first) != NRF_MESH_ADDRESS_TYPE_UNICAST ||
+        nrf_mesh_address_type_get(last) != NRF_MESH_ADDRESS_TYPE_UNICAST) {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    return sweep_start(p_client, NULL, first, (uint16_t) (last - first + 1), result_cb, done_cb);
+}
+
+uint32_t time_client_sweep_list_start(time_client_t * p_client, const uint16_t * p_list, uint16_t count,
+                                      time_client_request_cb_t result_cb, time_client_sweep_done_cb_t done_cb) {
+    if (p_client == NULL || p_list == NULL || result_cb == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (count == 0) {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        if (nrf_mesh_address_type_get(p_list[i]) != NRF_MESH_ADDRESS_TYPE_UNICAST) {
+            return NRF_ERROR_INVALID_ADDR;
+        }
+    }
+
+    return sweep_start(p_client, p_list, 0, count, result_cb, done_cb);
+}
+
+void time_client_sweep_stop(time_client_t * p_client) {
+    if (p_client == NULL || !p_client->sweep.active) {
+        return;
+    }
+
+    sweep_end(p_client, true);
+}
+#endif
+
+#if TIME_CLIENT_FLEET_TABLE_SIZE
+const time_client_fleet_entry_t * time_client_fleet_find(const time_client_t * p_client, uint16_t src) {
+    if (p_client == NULL) {
+        return NULL;
+    }
+
+    uint16_t index = p_client->fleet_index[fleet_slot_find(p_client, src)];
+    return (index == FLEET_INDEX_EMPTY) ? NULL : &p_client->fleet[index];
+}
+
+uint16_t time_client_fleet_count_get(const time_client_t * p_client) {
+    return (p_client == NULL) ? 0 : p_client->fleet_count;
+}
+
+const time_client_fleet_entry_t * time_client_fleet_get(const time_client_t * p_client, uint16_t index) {
+    if (p_client == NULL || index >= p_client->fleet_count) {
+        return NULL;
+    }
+    return &p_client->fleet[index];
+}
+
+void time_client_fleet_clear(time_client_t * p_client) {
+    if (p_client == NULL) {
+        return;
+    }
+
+    memset(p_client->fleet_index, 0xFF, sizeof(p_client->fleet_index));
+    p_client->fleet_count = 0;
+    p_client->fleet_dropped = 0;
+    p_client->fleet_local_timestamp = timer_now();
+}
+#endif
@@ -0,0 +1,210 @@
+#include "time_model_journal.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "nrf_error.h"
+#include "time_model_messages.h"
+
+#define PAGE_MAGIC (0x544D4A31) /* "TMJ1" */
+
+/* The saved state is laid out in the bytes of a record like the fields of a message, least significant byte first */
+static const time_model_msg_field_t m_saved_state_fields[] = {
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, tai_seconds, 0, 40),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, subsecond, 40, 8),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, uncertainty, 48, 8),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, time_role, 56, 8),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, time_zone_change, 64, 40),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, time_zone_offset_current, 104, 8),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, time_zone_offset_new, 112, 8),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, tai_utc_delta_change, 120, 40),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, tai_utc_delta_current, 160, 16),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, tai_utc_delta_new, 176, 16),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, subsecond_fraction, 192, 16),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, anchor_tick, 208, 32),
+    TIME_MODEL_MSG_FIELD(time_model_saved_state_t, last_sync_tai_seconds, 240, 40),
+};
+
+static const time_model_msg_format_t m_saved_state_format =
+    TIME_MODEL_MSG_FORMAT(time_model_saved_state_t, m_saved_state_fields, TIME_MODEL_SAVED_STATE_SIZE);
+
+/** Page header, followed by the record slots */
+typedef struct {
+    uint32_t magic;
+    uint32_t page_seq;
+} page_header_t;
+
+static inline uint32_t page_slot_count(const time_model_flash_t * p_flash) {
+    return (p_flash->page_size - sizeof(page_header_t)) / sizeof(time_model_journal_record_t);
+}
+
+static inline uint32_t slot_offset(const time_model_flash_t * p_flash, uint16_t page, uint32_t slot) {
+    return page * p_flash->page_size + sizeof(page_header_t) + slot * sizeof(time_model_journal_record_t);
+}
+
+static uint32_t record_crc(const time_model_journal_record_t * p_record) {
+    /* CRC-32, bitwise, as records are only written on state changes */
+    uint32_t crc = ~p_record->seq;
+
+    for (size_t i = 0; i < TIME_MODEL_SAVED_STATE_SIZE; i++) {
+        crc ^= p_record->state[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static bool slot_is_erased(const time_model_flash_t * p_flash, uint16_t page, uint32_t slot) {
+    uint32_t seq;
+    if (p_flash->read(p_flash->p_context, slot_offset(p_flash, page, slot), &seq, sizeof(seq)) != NRF_SUCCESS) {
+        return false;
+    }
+    return seq == TIME_MODEL_FLASH_ERASED_WORD;
+}
+
+/** Binary search for the first erased slot, as the slots of a page are written in order */
+static uint32_t page_used_slots_get(const time_model_flash_t * p_flash, uint16_t page) {
+    uint32_t low = 0;
+    uint32_t high = page_slot_count(p_flash);
+
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (slot_is_erased(p_flash, page, mid)) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+/** Finds the last valid record of a page, skipping back over a record torn by a reset while it was written */
+static bool page_last_record_get(const time_model_flash_t * p_flash, uint16_t page, uint32_t used_slots,
+                                 time_model_journal_record_t * p_record) {
+    while (used_slots > 0) {
+        used_slots--;
+        if (p_flash->read(p_flash->p_context, slot_offset(p_flash, page, used_slots), p_record,
+                          sizeof(time_model_journal_record_t)) == NRF_SUCCESS &&
+            p_record->crc == record_crc(p_record)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t page_start(time_model_journal_t * p_journal, uint16_t page, uint32_t page_seq) {
+    const time_model_flash_t * p_flash = p_journal->p_flash;
+    page_header_t header = {
+        .magic = PAGE_MAGIC,
+        .page_seq = page_seq
+    };
+
+    uint32_t status = p_flash->erase_page(p_flash->p_context, page);
+    if (status == NRF_SUCCESS) {
+        status = p_flash->write(p_flash->p_context, page * p_flash->page_size, &header, sizeof(header));
+    }
+    if (status == NRF_SUCCESS) {
+        p_journal->page = page;
+        p_journal->page_seq = page_seq;
+        p_journal->next_slot = 0;
+    }
+    return status;
+}
+
+uint32_t time_model_journal_open(time_model_journal_t * p_journal, const time_model_flash_t * p_flash) {
+    if (p_journal == NULL || p_flash == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (p_flash->page_count < 2 || p_flash->page_size % 4 != 0 ||
+        p_flash->page_size < sizeof(page_header_t) + sizeof(time_model_journal_record_t)) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memset(p_journal, 0, sizeof(time_model_journal_t));
+    p_journal->p_flash = p_flash;
+
+    /* The active page is the one with the highest sequence number */
+    bool found = false;
+    for (uint16_t page = 0; page < p_flash->page_count; page++) {
+        page_header_t header;
+        uint32_t status = p_flash->read(p_flash->p_context, page * p_flash->page_size, &header, sizeof(header));
+        if (status != NRF_SUCCESS) {
+            return status;
+        }
+        if (header.magic == PAGE_MAGIC && header.page_seq != TIME_MODEL_FLASH_ERASED_WORD &&
+            (!found || header.page_seq > p_journal->page_seq)) {
+            p_journal->page = page;
+            p_journal->page_seq = header.page_seq;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return page_start(p_journal, 0, 1);
+    }
+
+    p_journal->next_slot = page_used_slots_get(p_flash, p_journal->page);
+    p_journal->has_last = page_last_record_get(p_flash, p_journal->page, p_journal->next_slot, &p_journal->last);
+
+    /* A reset right after moving on to a new page leaves its last record on the previous one */
+    if (!p_journal->has_last) {
+        uint16_t previous = (p_journal->page + p_flash->page_count - 1) % p_flash->page_count;
+        page_header_t header;
+        if (p_flash->read(p_flash->p_context, previous * p_flash->page_size, &header, sizeof(header)) == NRF_SUCCESS &&
+            header.magic == PAGE_MAGIC && header.page_seq == p_journal->page_seq - 1) {
+            p_journal->has_last = page_last_record_get(p_flash, previous, page_used_slots_get(p_flash, previous),
+                                                       &p_journal->last);
+        }
+    }
+
+    p_journal->seq = p_journal->has_last ? p_journal->last.seq : 0;
+    return NRF_SUCCESS;
+}
+
+uint32_t time_model_journal_read(const time_model_journal_t * p_journal, time_model_saved_state_t * p_state) {
+    if (p_journal == NULL || p_state == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    if (!p_journal->has_last) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    time_model_msg_decode(&m_saved_state_format, p_journal->last.state, TIME_MODEL_SAVED_STATE_SIZE, p_state);
+    return NRF_SUCCESS;
+}
+
+uint32_t time_model_journal_write(time_model_journal_t * p_journal, const time_model_saved_state_t * p_state) {
+    if (p_journal == NULL || p_state == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    const time_model_flash_t * p_flash = p_journal->p_flash;
+    uint32_t status;
+
+    if (p_journal->next_slot >= page_slot_count(p_flash)) {
+        status = page_start(p_journal, (p_journal->page + 1) % p_flash->page_count, p_journal->page_seq + 1);
+        if (status != NRF_SUCCESS) {
+            return status;
+        }
+    }
+
+    time_model_journal_record_t record;
+    record.seq = p_journal->seq + 1;
+    (void) time_model_msg_encode(&m_saved_state_format, p_state, record.state);
+    record.crc = record_crc(&record);
+
+    /* The slot is used up even if the write fails half way, as it can no longer be written to */
+    status = p_flash->write(p_flash->p_context, slot_offset(p_flash, p_journal->page, p_journal->next_slot),
+                            &record, sizeof(record));
+    p_journal->next_slot++;
+    if (status == NRF_SUCCESS) {
+        p_journal->seq = record.seq;
+        p_journal->last = record;
+        p_journal->has_last = true;
+    }
+    return status;
+}
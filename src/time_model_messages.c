@@ -0,0 +1,134 @@
+#include "time_model_messages.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static const time_model_msg_field_t m_time_set_fields[] = {
+    TIME_MODEL_MSG_FIELD(time_set_msg_pkt_t, tai_seconds, 0, 40),
+    TIME_MODEL_MSG_FIELD(time_set_msg_pkt_t, subsecond, 40, 8),
+    TIME_MODEL_MSG_FIELD(time_set_msg_pkt_t, uncertainty, 48, 8),
+    TIME_MODEL_MSG_FIELD(time_set_msg_pkt_t, time_authority, 56, 1),
+    TIME_MODEL_MSG_FIELD(time_set_msg_pkt_t, tai_utc_delta, 57, 15),
+    TIME_MODEL_MSG_FIELD(time_set_msg_pkt_t, time_zone_offset, 72, 8),
+};
+
+static const time_model_msg_field_t m_time_zone_set_fields[] = {
+    TIME_MODEL_MSG_FIELD(time_zone_set_msg_pkt_t, time_zone_offset_new, 0, 8),
+    TIME_MODEL_MSG_FIELD(time_zone_set_msg_pkt_t, time_zone_change, 8, 40),
+};
+
+static const time_model_msg_field_t m_time_zone_status_fields[] = {
+    TIME_MODEL_MSG_FIELD(time_zone_status_msg_pkt_t, time_zone_offset_current, 0, 8),
+    TIME_MODEL_MSG_FIELD(time_zone_status_msg_pkt_t, time_zone_offset_new, 8, 8),
+    TIME_MODEL_MSG_FIELD(time_zone_status_msg_pkt_t, time_zone_change, 16, 40),
+};
+
+/* The TAI-UTC Delta fields are followed by a padding bit */
+static const time_model_msg_field_t m_tai_utc_delta_set_fields[] = {
+    TIME_MODEL_MSG_FIELD(tai_utc_delta_set_msg_pkt_t, tai_utc_delta_new, 0, 15),
+    TIME_MODEL_MSG_FIELD(tai_utc_delta_set_msg_pkt_t, tai_utc_delta_change, 16, 40),
+};
+
+static const time_model_msg_field_t m_tai_utc_delta_status_fields[] = {
+    TIME_MODEL_MSG_FIELD(tai_utc_delta_status_msg_pkt_t, tai_utc_delta_current, 0, 15),
+    TIME_MODEL_MSG_FIELD(tai_utc_delta_status_msg_pkt_t, tai_utc_delta_new, 16, 15),
+    TIME_MODEL_MSG_FIELD(tai_utc_delta_status_msg_pkt_t, tai_utc_delta_change, 32, 40),
+};
+
+static const time_model_msg_field_t m_time_role_set_fields[] = {
+    TIME_MODEL_MSG_FIELD(time_role_set_msg_pkt_t, time_role, 0, 8),
+};
+
+static const time_model_msg_field_t m_time_role_status_fields[] = {
+    TIME_MODEL_MSG_FIELD(time_role_status_msg_pkt_t, time_role, 0, 8),
+};
+
+const time_model_msg_format_t time_set_msg_format =
+    TIME_MODEL_MSG_FORMAT(time_set_msg_pkt_t, m_time_set_fields, TIME_SET_LEN);
+const time_model_msg_format_t time_zone_set_msg_format =
+    TIME_MODEL_MSG_FORMAT(time_zone_set_msg_pkt_t, m_time_zone_set_fields, TIME_ZONE_SET_LEN);
+const time_model_msg_format_t time_zone_status_msg_format =
+    TIME_MODEL_MSG_FORMAT(time_zone_status_msg_pkt_t, m_time_zone_status_fields, TIME_ZONE_STATUS_LEN);
+const time_model_msg_format_t tai_utc_delta_set_msg_format =
+    TIME_MODEL_MSG_FORMAT(tai_utc_delta_set_msg_pkt_t, m_tai_utc_delta_set_fields, TAI_UTC_DELTA_SET_LEN);
+const time_model_msg_format_t tai_utc_delta_status_msg_format =
+    TIME_MODEL_MSG_FORMAT(tai_utc_delta_status_msg_pkt_t, m_tai_utc_delta_status_fields, TAI_UTC_DELTA_STATUS_LEN);
+const time_model_msg_format_t time_role_set_msg_format =
+    TIME_MODEL_MSG_FORMAT(time_role_set_msg_pkt_t, m_time_role_set_fields, TIME_ROLE_SET_LEN);
+const time_model_msg_format_t time_role_status_msg_format =
+    TIME_MODEL_MSG_FORMAT(time_role_status_msg_pkt_t, m_time_role_status_fields, TIME_ROLE_STATUS_LEN);
+
+static uint64_t member_get(const uint8_t * p_member, uint8_t size) {
+    switch (size) {
+        case sizeof(uint8_t):
+            return *p_member;
+        case sizeof(uint16_t):
+            return *(const uint16_t *) p_member;
+        case sizeof(uint32_t):
+            return *(const uint32_t *) p_member;
+        default:
+            return *(const uint64_t *) p_member;
+    }
+}
+
+static void member_set(uint8_t * p_member, uint8_t size, uint64_t value) {
+    switch (size) {
+        case sizeof(uint8_t):
+            *p_member = (uint8_t) value;
+            break;
+        case sizeof(uint16_t):
+            *(uint16_t *) p_member = (uint16_t) value;
+            break;
+        case sizeof(uint32_t):
+            *(uint32_t *) p_member = (uint32_t) value;
+            break;
+        default:
+            *(uint64_t *) p_member = value;
+            break;
+    }
+}
+
+/** ORs a field into a zeroed payload, least significant byte first */
+static void field_write(uint8_t * p_buffer, const time_model_msg_field_t * p_field, uint64_t value) {
+    uint8_t shift = p_field->bit_offset & 7;
+    uint64_t bits = (value & (((uint64_t) 1 << p_field->bit_width) - 1)) << shift;
+    uint8_t bytes = (uint8_t) ((shift + p_field->bit_width + 7) >> 3);
+
+    for (uint8_t i = 0; i < bytes; i++) {
+        p_buffer[(p_field->bit_offset >> 3) + i] |= (uint8_t) (bits >> (8 * i));
+    }
+}
+
+static uint64_t field_read(const uint8_t * p_data, const time_model_msg_field_t * p_field) {
+    uint8_t shift = p_field->bit_offset & 7;
+    uint8_t bytes = (uint8_t) ((shift + p_field->bit_width + 7) >> 3);
+    uint64_t bits = 0;
+
+    for (uint8_t i = bytes; i > 0; i--) {
+        bits = (bits << 8) | p_data[(p_field->bit_offset >> 3) + i - 1];
+    }
+    return (bits >> shift) & (((uint64_t) 1 << p_field->bit_width) - 1);
+}
+
+uint16_t time_model_msg_encode(const time_model_msg_format_t * p_format, const void * p_msg, uint8_t * p_buffer) {
+    memset(p_buffer, 0, p_format->length);
+
+    for (uint8_t i = 0; i < p_format->field_count; i++) {
+        const time_model_msg_field_t * p_field = &p_format->p_fields[i];
+        field_write(p_buffer, p_field, member_get((const uint8_t *) p_msg + p_field->member_offset, p_field->member_size));
+    }
+    return p_format->length;
+}
+
+void time_model_msg_decode(const time_model_msg_format_t * p_format, const uint8_t * p_data, uint16_t length, void * p_msg) {
+    memset(p_msg, 0, p_format->msg_size);
+
+    for (uint8_t i = 0; i < p_format->field_count; i++) {
+        const time_model_msg_field_t * p_field = &p_format->p_fields[i];
+        if (p_field->bit_offset + p_field->bit_width > length * 8) {
+            continue;
+        }
+        member_set((uint8_t *) p_msg + p_field->member_offset, p_field->member_size, field_read(p_data, p_field));
+    }
+}
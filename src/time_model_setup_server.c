@@ -2,41 +2,611 @@
 
 #include "time_model_common.h"
 #include "time_model_messages.h"
+#include "time_model_stats.h"
+#include "time_model_trace.h"
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "access.h"
 #include "access_config.h"
 #include "device_state_manager.h"
 
-static time_server_callbacks_t time_serv_callbacks = {0};
-static time_setup_server_callbacks_t time_setup_serv_callbacks = {0};
+#if TIME_MODEL_DELAY_COMPENSATION || TIME_MODEL_STATS
+#include "timer.h"
+#endif
 
 #if TIME_MODEL_USE_APP_TIMER
 #include "app_timer.h"
 
 #define ONE_SEC (APP_TIMER_TICKS(1000))
 
+/** Single shot timer shared by all the time servers, started for the earliest of their deadlines */
 APP_TIMER_DEF(m_time_model_timer);
+
+/** Time servers driven by m_time_model_timer, see time_model_timer_add() */
+static time_server_t * m_time_servers;
+
+/** Set while the timer handler serves the time servers, so that the timer is only restarted once at its end */
+static bool m_timer_dispatching;
+#endif
+
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+#define PUBLISH_HOLDOFF (APP_TIMER_TICKS(TIME_MODEL_PUBLISH_HOLDOFF_MS))
+
+/** Status messages that can be waiting for the end of the publication hold-off window */
+#define PENDING_PUBLISH_TIME_STATUS (1 << 0)
+#define PENDING_PUBLISH_TIME_ZONE_STATUS (1 << 1)
+#define PENDING_PUBLISH_TAI_UTC_DELTA_STATUS (1 << 2)
+#define PENDING_PUBLISH_TIME_ROLE_STATUS (1 << 3)
+#endif
+
+/** The time server is always the one within a time setup server, see time_setup_server_init() */
+#define TIME_SETUP_SERVER_GET(p_server) \
+    ((time_setup_server_t *) ((uint8_t *) (p_server) - offsetof(time_setup_server_t, time_server)))
+
+#if TIME_MODEL_TICKLESS
+#define TICKLESS_MAX_SLEEP (APP_TIMER_TICKS(TIME_MODEL_TICKLESS_MAX_SLEEP_MS))
 #endif
 
 /********************************************************************* 
     TIME SERVER AND SETUP SERVER STATES IMPLEMENTATION
 **********************************************************************/
 
+#if TIME_MODEL_USE_APP_TIMER
+/** Ticks until an RTC counter deadline, 0 if it has passed. Deadlines are never set more than half the counter range ahead */
+static uint32_t deadline_remaining_get(uint32_t deadline, uint32_t now) {
+    uint32_t remaining = app_timer_cnt_diff_compute(deadline, now);
+    return remaining > APP_TIMER_MAX_CNT_VAL / 2 ? 0 : remaining;
+}
+
+/** Restarts the shared timer for the earliest deadline of the time servers, or leaves it stopped if they have none */
+static uint32_t shared_timer_restart(void) {
+    if (m_timer_dispatching) {
+        return NRF_SUCCESS;
+    }
+
+    uint32_t now = app_timer_cnt_get();
+    uint32_t timeout = UINT32_MAX;
+    for (const time_server_t * p_server = m_time_servers; p_server != NULL; p_server = p_server->p_next) {
+        uint32_t remaining;
+        if (p_server->timer_active) {
+            remaining = deadline_remaining_get(p_server->timer_deadline, now);
+            if (remaining < timeout) {
+                timeout = remaining;
+            }
+        }
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+        if (p_server->pending_publish != 0) {
+            remaining = deadline_remaining_get(p_server->publish_deadline, now);
+            if (remaining < timeout) {
+                timeout = remaining;
+            }
+        }
+#endif
+    }
+
+    app_timer_stop(m_time_model_timer);
+    if (timeout == UINT32_MAX) {
+        return NRF_SUCCESS;
+    }
+    if (timeout < APP_TIMER_MIN_TIMEOUT_TICKS) {
+        timeout = APP_TIMER_MIN_TIMEOUT_TICKS;
+    }
+    return app_timer_start(m_time_model_timer, timeout, NULL);
+}
+
+/** Sets when the timekeeping of a time server is next due */
+static void time_model_timer_schedule(time_server_t * p_server, uint32_t timeout) {
+    p_server->timer_deadline = (app_timer_cnt_get() + timeout) & APP_TIMER_MAX_CNT_VAL;
+    p_server->timer_active = true;
+    (void) shared_timer_restart();
+}
+
+/** Stops the timekeeping of a time server. The shared timer may still expire for it, which is then ignored */
+static inline void time_model_timer_stop(time_server_t * p_server) {
+    p_server->timer_active = false;
+}
+#endif
+
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+/** Adds a status message to publish at the end of the hold-off window, starting the window if needed */
+static uint32_t publish_holdoff_schedule(time_server_t * p_server, uint8_t pending_publish) {
+    if (p_server->pending_publish == 0) {
+        p_server->publish_deadline = (app_timer_cnt_get() + PUBLISH_HOLDOFF) & APP_TIMER_MAX_CNT_VAL;
+        p_server->pending_publish = pending_publish;
+
+        uint32_t status = shared_timer_restart();
+        if (status != NRF_SUCCESS) {
+            p_server->pending_publish = 0;
+        }
+        return status;
+    }
+
+    p_server->pending_publish |= pending_publish;
+    return NRF_SUCCESS;
+}
+
+/** Publishes the status messages that waited for the end of the hold-off window */
+static void publish_holdoff_expire(time_server_t * p_server) {
+    uint8_t pending_publish = p_server->pending_publish;
+
+    p_server->pending_publish = 0;
+
+    /* The role goes first, as it decides whether the other status messages may be published */
+    if (pending_publish & PENDING_PUBLISH_TIME_ROLE_STATUS) {
+        (void) time_setup_server_time_role_status_publish(TIME_SETUP_SERVER_GET(p_server));
+    }
+    if (pending_publish & PENDING_PUBLISH_TIME_STATUS) {
+        (void) time_server_time_status_publish(p_server);
+    }
+    if (pending_publish & PENDING_PUBLISH_TIME_ZONE_STATUS) {
+        (void) time_server_time_zone_status_publish(p_server);
+    }
+    if (pending_publish & PENDING_PUBLISH_TAI_UTC_DELTA_STATUS) {
+        (void) time_server_tai_utc_delta_status_publish(p_server);
+    }
+}
+#endif
+
+/**
+ * Internally, the time is kept as a fixed point number of seconds: the 40 bits of TAI seconds followed by
+ * the 8 bits of subsecond and the 16 bits of subsecond_fraction. It is only rounded to the 1/256 second
+ * resolution of the subsecond state when a message is built
+ */
+#define TIME_FP_FRACTION_BITS (24)
+#define TIME_FP_ONE_SEC ((uint64_t) 1 << TIME_FP_FRACTION_BITS)
+#define TIME_FP_MAX_VAL (((uint64_t) TAI_TIME_MAX_VAL << TIME_FP_FRACTION_BITS) | (TIME_FP_ONE_SEC - 1))
+#define TIME_FP(tai_seconds, subsecond) (((uint64_t) (tai_seconds) << TIME_FP_FRACTION_BITS) | ((uint64_t) (subsecond) << 16))
+
+static inline uint64_t time_state_fp_get(const time_server_state_t * p_state) {
+    return TIME_FP(p_state->tai_seconds, p_state->subsecond) | p_state->subsecond_fraction;
+}
+
+static inline void time_state_fp_set(time_server_state_t * p_state, uint64_t time_fp) {
+    p_state->tai_seconds = time_fp >> TIME_FP_FRACTION_BITS;
+    p_state->subsecond = (uint8_t) (time_fp >> 16);
+    p_state->subsecond_fraction = (uint16_t) time_fp;
+}
+
+/** Rounds a fixed point time to the nearest TAI seconds and subsecond representable in a message */
+static inline void time_fp_round(uint64_t time_fp, uint64_t * p_tai_seconds, uint8_t * p_subsecond) {
+    if (time_fp <= TIME_FP_MAX_VAL - (1 << 15)) {
+        time_fp += (1 << 15);
+    }
+    *p_tai_seconds = time_fp >> TIME_FP_FRACTION_BITS;
+    *p_subsecond = (uint8_t) (time_fp >> 16);
+}
+
+/**
+ * Applies all the pending changes that are due. Comparing with >= rather than == makes sure that
+ * a change is not lost when the time jumps over its second, e.g. on a resync or a late update
+ */
 static void current_time_check_time_changes(time_server_t * p_server) {
-    if (p_server->server_state.tai_seconds == p_server->server_state.time_zone_change &&
-	    p_server->server_state.time_zone_change != TIME_ZONE_CHANGE_UNKNOWN) {
-	    p_server->server_state.time_zone_offset_current = p_server->server_state.time_zone_offset_new;
+    uint8_t applied = 0;
+
+    while (applied < p_server->pending_change_count &&
+           p_server->pending_changes[applied].tai_seconds <= p_server->server_state.tai_seconds) {
+        switch (p_server->pending_changes[applied].type) {
+            case TIME_CHANGE_TIME_ZONE:
+                TIME_MODEL_TRACE_RECORD(TIME_MODEL_TRACE_TIME_CHANGE, TIME_CHANGE_TIME_ZONE, TIME_MODEL_TRACE_SRC_LOCAL,
+                                        p_server->server_state.time_zone_offset_current,
+                                        p_server->server_state.time_zone_offset_new);
+                p_server->server_state.time_zone_offset_current = p_server->server_state.time_zone_offset_new;
+                break;
+            case TIME_CHANGE_TAI_UTC_DELTA:
+                TIME_MODEL_TRACE_RECORD(TIME_MODEL_TRACE_TIME_CHANGE, TIME_CHANGE_TAI_UTC_DELTA, TIME_MODEL_TRACE_SRC_LOCAL,
+                                        p_server->server_state.tai_utc_delta_current,
+                                        p_server->server_state.tai_utc_delta_new);
+                p_server->server_state.tai_utc_delta_current = p_server->server_state.tai_utc_delta_new;
+                break;
+            default:
+                break;
+        }
+        applied++;
+    }
+
+    if (applied > 0) {
+        p_server->pending_change_count -= applied;
+        memmove(&p_server->pending_changes[0], &p_server->pending_changes[applied],
+                p_server->pending_change_count * sizeof(time_change_t));
+    }
+}
+
+/**
+ * Replaces the pending change of the given type, keeping the queue sorted. TIME_ZONE_CHANGE_UNKNOWN 
+ * and TAI_DELTA_CHANGE_UNKNOWN only cancel it
+ */
+static void time_change_schedule(time_server_t * p_server, time_change_type_t type, uint64_t tai_seconds) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < p_server->pending_change_count; i++) {
+        if (p_server->pending_changes[i].type != type) {
+            p_server->pending_changes[count++] = p_server->pending_changes[i];
+        }
+    }
+
+    if (tai_seconds != TAI_TIME_UNKNOWN) {
+        uint8_t i = count;
+        while (i > 0 && p_server->pending_changes[i - 1].tai_seconds > tai_seconds) {
+            p_server->pending_changes[i] = p_server->pending_changes[i - 1];
+            i--;
+        }
+        p_server->pending_changes[i].tai_seconds = tai_seconds;
+        p_server->pending_changes[i].type = type;
+        count++;
+    }
+
+    p_server->pending_change_count = count;
+    current_time_check_time_changes(p_server);
+}
+
+/** Time of the next pending change, or TAI_TIME_MAX_VAL if there is none */
+static inline uint64_t time_change_next_get(const time_server_t * p_server) {
+    return (p_server->pending_change_count > 0) ? p_server->pending_changes[0].tai_seconds : TAI_TIME_MAX_VAL;
+}
+
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+#define FLL_MAX_PPB ((int64_t) TIME_MODEL_FLL_MAX_PPM * 1000)
+
+/** Any offset measured from a Time Status message can be off by its 1/256 second resolution, at each end */
+#define FLL_OFFSET_RESOLUTION ((int64_t) 2 << 16)
+
+static void frequency_discipline_reset(time_server_t * p_server) {
+    p_server->fll_interval_start = 0;
+    p_server->fll_last_sync = 0;
+    p_server->fll_offset_sum = 0;
+    p_server->fll_residual_ppb = 0;
+}
+
+/**
+ * Accumulates the offset between the local clock and a sync, and once they span at least 
+ * TIME_MODEL_FLL_MIN_INTERVAL_S, corrects the estimated rate of the local clock by a fraction of the
+ * frequency error they reveal. Offsets larger than the oscillator could have drifted are time steps
+ * (e.g. the time authority was set) and restart the measurement instead.
+ */
+static void frequency_discipline_update(time_server_t * p_server, uint64_t local_time, uint64_t sync_time) {
+    int64_t offset = (int64_t) (sync_time - local_time);
+
+    if (p_server->fll_interval_start == 0 || sync_time <= p_server->fll_last_sync) {
+        p_server->fll_interval_start = sync_time;
+        p_server->fll_last_sync = sync_time;
+        p_server->fll_offset_sum = 0;
+        return;
+    }
+
+    int64_t max_offset = (int64_t) (((sync_time - p_server->fll_last_sync) * TIME_MODEL_FLL_MAX_PPM) / 1000000) +
+                         FLL_OFFSET_RESOLUTION;
+    p_server->fll_last_sync = sync_time;
+    if (offset > max_offset || offset < -max_offset) {
+        p_server->fll_interval_start = sync_time;
+        p_server->fll_offset_sum = 0;
+        return;
     }
 
-    if (p_server->server_state.tai_seconds == p_server->server_state.tai_utc_delta_change &&
-	    p_server->server_state.tai_utc_delta_change != TAI_DELTA_CHANGE_UNKNOWN) {
-	    p_server->server_state.tai_utc_delta_current = p_server->server_state.tai_utc_delta_new;
+    p_server->fll_offset_sum += offset;
+    uint64_t interval = sync_time - p_server->fll_interval_start;
+    if (interval < TIME_MODEL_FLL_MIN_INTERVAL_S * TIME_FP_ONE_SEC) {
+        return;
+    }
+
+    int64_t error_ppb = (p_server->fll_offset_sum * 1000000) / (int64_t) (interval / 1000);
+    int64_t correction_ppb = error_ppb / (1 << TIME_MODEL_FLL_GAIN_SHIFT);
+    int64_t drift_ppb = p_server->drift_ppb + correction_ppb;
+
+    /* What the correction left out, plus what the measurement cannot resolve over this interval */
+    int64_t residual_ppb = error_ppb - correction_ppb;
+    p_server->fll_residual_ppb = (uint32_t) ((residual_ppb < 0 ? -residual_ppb : residual_ppb) +
+                                             (FLL_OFFSET_RESOLUTION * 1000000) / (int64_t) (interval / 1000));
+    if (drift_ppb > FLL_MAX_PPB) {
+        drift_ppb = FLL_MAX_PPB;
+    } else if (drift_ppb < -FLL_MAX_PPB) {
+        drift_ppb = -FLL_MAX_PPB;
     }
+    p_server->drift_ppb = (int32_t) drift_ppb;
+
+    p_server->fll_interval_start = sync_time;
+    p_server->fll_offset_sum = 0;
+}
+#endif
+
+/** Applies a rate correction, in parts per billion, to an interval measured by the local clock */
+static inline uint64_t interval_correct(uint64_t interval, int32_t drift_ppb) {
+    int64_t correction = (int64_t) (interval / 1000000000) * drift_ppb +
+                         ((int64_t) (interval % 1000000000) * drift_ppb) / 1000000000;
+    return interval + correction;
+}
+
+/** Applies the estimated rate correction of the local clock to an interval measured by it */
+static inline uint64_t local_interval_correct(const time_server_t * p_server, uint64_t interval) {
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    return interval_correct(interval, p_server->drift_ppb);
+#else
+    return interval;
+#endif
 }
 
+#if TIME_MODEL_TICKLESS
+/** Time elapsed_ticks after anchor_time, for a local clock running off by drift_ppb */
+static uint64_t tickless_time_extrapolate(uint64_t anchor_time, int32_t drift_ppb, uint32_t elapsed_ticks) {
+    /* A time which was never set does not start counting from the epoch */
+    if ((anchor_time >> TIME_FP_FRACTION_BITS) == TAI_TIME_UNKNOWN) {
+        return anchor_time;
+    }
+
+    uint64_t elapsed_time = ((uint64_t) elapsed_ticks << TIME_FP_FRACTION_BITS) / APP_TIMER_CLOCK_FREQ;
+    return anchor_time + ((drift_ppb != 0) ? interval_correct(elapsed_time, drift_ppb) : elapsed_time);
+}
+
+static inline uint64_t tickless_time_compute(const time_server_t * p_server, uint32_t elapsed_ticks) {
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    return tickless_time_extrapolate(p_server->anchor_time, p_server->drift_ppb, elapsed_ticks);
+#else
+    return tickless_time_extrapolate(p_server->anchor_time, 0, elapsed_ticks);
+#endif
+}
+
+static void tickless_anchor_set(time_server_t * p_server) {
+    p_server->anchor_time = time_state_fp_get(&p_server->server_state);
+    p_server->anchor_tick = app_timer_cnt_get();
+}
+
+/**
+ * Brings the time state up to date from the anchor. The anchor itself is only moved forward 
+ * by the whole seconds elapsed, so that no rounding error accumulates across updates
+ */
+static void tickless_time_update(time_server_t * p_server) {
+    uint32_t elapsed = app_timer_cnt_diff_compute(app_timer_cnt_get(), p_server->anchor_tick);
+    uint32_t elapsed_seconds = elapsed / APP_TIMER_CLOCK_FREQ;
+
+    time_state_fp_set(&p_server->server_state, tickless_time_compute(p_server, elapsed));
+
+    /* An unknown anchor stays unknown, see tickless_time_compute() */
+    if ((p_server->anchor_time >> TIME_FP_FRACTION_BITS) != TAI_TIME_UNKNOWN) {
+        p_server->anchor_time += local_interval_correct(p_server, elapsed_seconds * TIME_FP_ONE_SEC);
+    }
+    p_server->anchor_tick = (p_server->anchor_tick + elapsed_seconds * APP_TIMER_CLOCK_FREQ) & APP_TIMER_MAX_CNT_VAL;
+    current_time_check_time_changes(p_server);
+}
+
+/**
+ * Sleeps until the next pending Time Zone / TAI-UTC Delta change, or for at most TICKLESS_MAX_SLEEP
+ * so that the RTC counter does not wrap around the anchor
+ */
+static void tickless_wakeup_schedule(time_server_t * p_server) {
+    tickless_time_update(p_server);
+
+    /* All the changes that are due were applied by the update, so the next one is in the future */
+    uint64_t tai_seconds = p_server->server_state.tai_seconds;
+    uint64_t next_change = time_change_next_get(p_server);
+
+    uint64_t timeout = TICKLESS_MAX_SLEEP;
+    if (next_change - tai_seconds < timeout / APP_TIMER_CLOCK_FREQ + 1) {
+        /* Wake up just after the start of the second at which the change happens */
+        timeout = (next_change - tai_seconds) * APP_TIMER_CLOCK_FREQ -
+                  (((uint64_t) p_server->server_state.subsecond * APP_TIMER_CLOCK_FREQ) >> 8) + 1;
+    }
+    if (timeout > TICKLESS_MAX_SLEEP) {
+        timeout = TICKLESS_MAX_SLEEP;
+    } else if (timeout < APP_TIMER_MIN_TIMEOUT_TICKS) {
+        timeout = APP_TIMER_MIN_TIMEOUT_TICKS;
+    }
+
+    time_model_timer_schedule(p_server, (uint32_t) timeout);
+}
+#endif
+
+#if TIME_MODEL_DELAY_COMPENSATION
+static inline uint64_t time_fp_from_us(uint64_t time_us) {
+    return (time_us << TIME_FP_FRACTION_BITS) / 1000000;
+}
+
+/** Estimates how late the time of a received Time Status message is by the time it is handled */
+static uint64_t rx_delay_get(const access_message_rx_t * p_rx_msg) {
+    uint64_t delay_us = 0;
+    
+    const nrf_mesh_rx_metadata_t * p_core_metadata = p_rx_msg->meta_data.p_core_metadata;
+    if (p_core_metadata != NULL && p_core_metadata->source == NRF_MESH_RX_SOURCE_SCANNER) {
+        delay_us += (uint32_t) (timer_now() - p_core_metadata->params.scanner.timestamp);
+    }
+
+    uint32_t hops = 1;
+#if TIME_STATUS_MSG_TTL > 0
+    if (p_rx_msg->meta_data.ttl < TIME_STATUS_MSG_TTL) {
+        hops += TIME_STATUS_MSG_TTL - p_rx_msg->meta_data.ttl;
+    }
+#endif
+    delay_us += (uint64_t) hops * TIME_MODEL_LINK_DELAY_US;
+
+    return time_fp_from_us(delay_us);
+}
+#endif
+
+/** Reads the current time without modifying the time state */
+static uint64_t current_time_get(const time_server_t * p_server) {
+#if TIME_MODEL_TICKLESS
+    uint32_t elapsed = app_timer_cnt_diff_compute(app_timer_cnt_get(), p_server->anchor_tick);
+    return tickless_time_compute(p_server, elapsed);
+#else
+    return time_state_fp_get(&p_server->server_state);
+#endif
+}
+
+/** Uncertainty of the time state at the given time */
+static uint8_t current_uncertainty_get(const time_server_t * p_server, uint64_t time_fp) {
+#if TIME_MODEL_UNCERTAINTY_GROWTH
+    uint64_t drift_ppb = (uint64_t) TIME_MODEL_UNCERTAINTY_DRIFT_PPM * 1000;
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    if (p_server->fll_residual_ppb != 0) {
+        drift_ppb = p_server->fll_residual_ppb;
+    }
+#endif
+    if (time_fp <= p_server->uncertainty_time) {
+        return p_server->server_state.uncertainty;
+    }
+
+    /* ppb over seconds gives nanoseconds, and the uncertainty is in 10 ms steps */
+    uint64_t elapsed_seconds = (time_fp - p_server->uncertainty_time) >> TIME_FP_FRACTION_BITS;
+    uint64_t uncertainty = p_server->server_state.uncertainty + (elapsed_seconds * drift_ppb) / 10000000;
+    return (uncertainty > UINT8_MAX) ? UINT8_MAX : (uint8_t) uncertainty;
+#else
+    return p_server->server_state.uncertainty;
+#endif
+}
+
+#if TIME_MODEL_STATE_SNAPSHOT
+static void state_copy_write(time_server_state_copy_t * p_copy, const time_server_t * p_server) {
+    p_copy->state = p_server->server_state;
+#if TIME_MODEL_TICKLESS
+    p_copy->anchor_time = p_server->anchor_time;
+    p_copy->anchor_tick = p_server->anchor_tick;
+#endif
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    p_copy->drift_ppb = p_server->drift_ppb;
+#endif
+}
+#endif
+
+/**
+ * Publishes the time state to time_server_state_snapshot(), at the end of everything that changes it. Each
+ * copy is written while the sequence number points the readers to the other one
+ */
+static inline void state_publish(time_server_t * p_server) {
+#if TIME_MODEL_STATE_SNAPSHOT
+    uint32_t seq = p_server->state_seq;
+
+    __atomic_store_n(&p_server->state_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    state_copy_write(&p_server->state_copies[0], p_server);
+
+    __atomic_store_n(&p_server->state_seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    state_copy_write(&p_server->state_copies[1], p_server);
+#endif
+}
+
+/** Sets the uncertainty of the time state as of the given time */
+static void uncertainty_set(time_server_t * p_server, uint8_t uncertainty, uint64_t time_fp) {
+    p_server->server_state.uncertainty = uncertainty;
+#if TIME_MODEL_UNCERTAINTY_GROWTH
+    p_server->uncertainty_time = time_fp;
+#endif
+}
+
+#if TIME_MODEL_PERSISTENCE
+static void state_save(time_server_t * p_server) {
+    if (p_server->p_journal == NULL) {
+        return;
+    }
+
+    /* In the tick mode, the time is that of the last tick, up to one second before the counter value */
+    uint64_t time_fp = current_time_get(p_server);
+    time_model_saved_state_t state = {
+        .tai_seconds = time_fp >> TIME_FP_FRACTION_BITS,
+        .subsecond = (uint8_t) (time_fp >> 16),
+        .subsecond_fraction = (uint16_t) time_fp,
+        .uncertainty = current_uncertainty_get(p_server, time_fp),
+        .time_role = p_server->server_state.time_role,
+        .time_zone_offset_current = time_zone_offset_encode(p_server->server_state.time_zone_offset_current),
+        .time_zone_offset_new = time_zone_offset_encode(p_server->server_state.time_zone_offset_new),
+        .time_zone_change = p_server->server_state.time_zone_change,
+        .tai_utc_delta_current = tai_utc_delta_encode(p_server->server_state.tai_utc_delta_current),
+        .tai_utc_delta_new = tai_utc_delta_encode(p_server->server_state.tai_utc_delta_new),
+        .tai_utc_delta_change = p_server->server_state.tai_utc_delta_change,
+        .last_sync_tai_seconds = p_server->last_sync_time >> TIME_FP_FRACTION_BITS,
+#if TIME_MODEL_USE_APP_TIMER && !TIME_MODEL_WARM_START
+        .anchor_tick = app_timer_cnt_get()
+#endif
+    };
+
+#if TIME_MODEL_WARM_START
+    if (p_server->retained_counter_get != NULL) {
+        state.anchor_tick = p_server->retained_counter_get();
+    }
+#endif
+
+    if (time_model_journal_write(p_server->p_journal, &state) == NRF_SUCCESS) {
+        p_server->save_time = time_fp;
+    }
+}
+
+/** Saves the state after a sync, unless it was saved recently */
+static void state_save_on_sync(time_server_t * p_server, uint64_t sync_time) {
+    if (sync_time < p_server->save_time ||
+        sync_time - p_server->save_time >= (uint64_t) TIME_MODEL_PERSIST_SYNC_INTERVAL_S * TIME_FP_ONE_SEC) {
+        state_save(p_server);
+    }
+}
+
+#if TIME_MODEL_WARM_START
+/** The saved time is the time of the last tick in the tick mode, up to one second before the saved counter value */
+#if TIME_MODEL_TICKLESS
+#define WARM_START_SAVE_UNCERTAINTY (1)
+#else
+#define WARM_START_SAVE_UNCERTAINTY (100)
+#endif
+
+/** Rebuilds the time from the saved time and the ticks of the retained counter since it was saved */
+static void warm_start(time_server_t * p_server, const time_model_saved_state_t * p_state) {
+    uint32_t elapsed_ticks = p_server->retained_counter_get() - (uint32_t) p_state->anchor_tick;
+    uint64_t elapsed = ((uint64_t) elapsed_ticks << TIME_FP_FRACTION_BITS) / TIME_MODEL_RETAINED_COUNTER_FREQ;
+    uint64_t time_fp = (TIME_FP(p_state->tai_seconds, p_state->subsecond) | p_state->subsecond_fraction) + elapsed;
+
+    /* ppm over seconds gives microseconds, and the uncertainty is in 10 ms steps */
+    uint64_t drift = ((elapsed >> TIME_FP_FRACTION_BITS) * TIME_MODEL_UNCERTAINTY_DRIFT_PPM + 9999) / 10000;
+    uint64_t uncertainty = p_state->uncertainty + drift + WARM_START_SAVE_UNCERTAINTY;
+
+    if (time_fp > TIME_FP_MAX_VAL || uncertainty > TIME_MODEL_WARM_START_MAX_UNCERTAINTY) {
+        return;
+    }
+
+    time_state_fp_set(&p_server->server_state, time_fp);
+    uncertainty_set(p_server, (uint8_t) uncertainty, time_fp);
+    /* The age of the last sync keeps counting through the reset, see time_status_sync_check() */
+    p_server->last_sync_time = TIME_FP(p_state->last_sync_tai_seconds, 0);
+    current_time_check_time_changes(p_server);
+}
+#endif
+
+static void state_restore(time_server_t * p_server) {
+    time_model_saved_state_t state;
+
+    if (p_server->p_journal == NULL || time_model_journal_read(p_server->p_journal, &state) != NRF_SUCCESS) {
+        return;
+    }
+
+    p_server->server_state.time_role = (time_role_t) state.time_role;
+    p_server->server_state.time_authority = (state.time_role == TIME_ROLE_AUTHORITY);
+    p_server->server_state.time_zone_offset_current = time_zone_offset_decode(state.time_zone_offset_current);
+    p_server->server_state.time_zone_offset_new = time_zone_offset_decode(state.time_zone_offset_new);
+    p_server->server_state.time_zone_change = state.time_zone_change;
+    p_server->server_state.tai_utc_delta_current = tai_utc_delta_decode(state.tai_utc_delta_current);
+    p_server->server_state.tai_utc_delta_new = tai_utc_delta_decode(state.tai_utc_delta_new);
+    p_server->server_state.tai_utc_delta_change = state.tai_utc_delta_change;
+    time_change_schedule(p_server, TIME_CHANGE_TIME_ZONE, state.time_zone_change);
+    time_change_schedule(p_server, TIME_CHANGE_TAI_UTC_DELTA, state.tai_utc_delta_change);
+
+#if TIME_MODEL_WARM_START
+    if (state.tai_seconds != TAI_TIME_UNKNOWN && p_server->retained_counter_get != NULL) {
+        warm_start(p_server, &state);
+    }
+#endif
+}
+#endif
+
+#if TIME_MODEL_USE_APP_TIMER
+/** (Re)starts the timekeeping from the current time state */
+static void time_model_timer_start(time_server_t * p_server) {
+#if TIME_MODEL_TICKLESS
+    tickless_anchor_set(p_server);
+    tickless_wakeup_schedule(p_server);
+#else
+    time_model_timer_schedule(p_server, ONE_SEC);
+#endif
+}
+#endif
+
 void time_state_update_time(time_server_t * p_server, uint64_t tai_seconds, uint8_t subsecond) {
     if (p_server == NULL) {
         return;
@@ -46,23 +616,51 @@ void time_state_update_time(time_server_t * p_server, uint64_t tai_seconds, uint
 	    return;
     }
 
-    p_server->server_state.tai_seconds = tai_seconds;
-    p_server->server_state.subsecond = subsecond;
+#if TIME_MODEL_TICKLESS
+    time_model_timer_stop(p_server);
+#endif
+    uint8_t uncertainty = current_uncertainty_get(p_server, current_time_get(p_server));
+    time_state_fp_set(&p_server->server_state, TIME_FP(tai_seconds, subsecond));
+    uncertainty_set(p_server, uncertainty, TIME_FP(tai_seconds, subsecond));
+    p_server->last_sync_time = TIME_FP(tai_seconds, subsecond);
     current_time_check_time_changes(p_server);
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    frequency_discipline_reset(p_server);
+#endif
+#if TIME_MODEL_TICKLESS
+    time_model_timer_start(p_server);
+#endif
+    state_publish(p_server);
 }
 
 void time_state_update_time_delta(time_server_t * p_server, uint64_t delta_tai_seconds, uint8_t delta_subsecond) {
     if (p_server == NULL) {
         return;
     }
-    
-    if (!validate_tai_time_arg(p_server->server_state.tai_seconds + delta_tai_seconds)) {
+
+#if TIME_MODEL_TICKLESS
+    time_model_timer_stop(p_server);
+    tickless_time_update(p_server);
+#endif
+    uint64_t time_fp = time_state_fp_get(&p_server->server_state);
+    if (!validate_tai_time_arg(delta_tai_seconds) ||
+        TIME_FP(delta_tai_seconds, delta_subsecond) > TIME_FP_MAX_VAL - time_fp) {
+#if TIME_MODEL_TICKLESS
+        tickless_wakeup_schedule(p_server);
+        state_publish(p_server);
+#endif
 	    return;
     }
 
-    p_server->server_state.tai_seconds += delta_tai_seconds;
-    p_server->server_state.subsecond += delta_subsecond;
+    time_state_fp_set(&p_server->server_state, time_fp + TIME_FP(delta_tai_seconds, delta_subsecond));
     current_time_check_time_changes(p_server);
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    frequency_discipline_reset(p_server);
+#endif
+#if TIME_MODEL_TICKLESS
+    time_model_timer_start(p_server);
+#endif
+    state_publish(p_server);
 }
 
 
@@ -71,14 +669,122 @@ void time_state_update_uncertainty(time_server_t * p_server, uint8_t uncertainty
         return;
     }
 
-    p_server->server_state.uncertainty = uncertainty;
+    uncertainty_set(p_server, uncertainty, current_time_get(p_server));
+    state_publish(p_server);
 }
 
+uint32_t time_server_state_get_time(time_server_t * p_server, uint64_t * p_tai_seconds, uint8_t * p_subsecond) {
+    if (p_server == NULL || p_tai_seconds == NULL || p_subsecond == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+#if TIME_MODEL_TICKLESS
+    tickless_time_update(p_server);
+    state_publish(p_server);
+#endif
+    *p_tai_seconds = p_server->server_state.tai_seconds;
+    *p_subsecond = p_server->server_state.subsecond;
+    return NRF_SUCCESS;
+}
+
+#if TIME_MODEL_STATE_SNAPSHOT
+uint32_t time_server_state_snapshot(const time_server_t * p_server, time_server_state_t * p_state) {
+    if (p_server == NULL || p_state == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    /* A writer interrupted here moves on to the other copy, so this only retries when preempted by a writer */
+    time_server_state_copy_t copy;
+    uint32_t seq;
+    do {
+        seq = __atomic_load_n(&p_server->state_seq, __ATOMIC_ACQUIRE);
+        copy = p_server->state_copies[seq & 1];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&p_server->state_seq, __ATOMIC_RELAXED) != seq);
+
+#if TIME_MODEL_TICKLESS
+    uint32_t elapsed = app_timer_cnt_diff_compute(app_timer_cnt_get(), copy.anchor_tick);
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    time_state_fp_set(&copy.state, tickless_time_extrapolate(copy.anchor_time, copy.drift_ppb, elapsed));
+#else
+    time_state_fp_set(&copy.state, tickless_time_extrapolate(copy.anchor_time, 0, elapsed));
+#endif
+#endif
+    *p_state = copy.state;
+    return NRF_SUCCESS;
+}
+#endif
+
 #if TIME_MODEL_USE_APP_TIMER
-static void time_model_app_timer_cb(void * p_context) {
-    time_server_t * p_server = (time_server_t *) p_context;
+/** Timekeeping of a time server, once its deadline has passed */
+static void time_model_timer_expire(time_server_t * p_server, uint32_t now) {
+#if TIME_MODEL_TRACE
+    uint64_t previous_tai_seconds = p_server->server_state.tai_seconds;
+    /* Tickless wakeups are rare, but a record per 1 second tick would flush the ring within a minute,
+       so the ticks are only traced when the handler ran so late that the next one was already due */
+    bool trace = TIME_MODEL_TICKLESS || app_timer_cnt_diff_compute(now, p_server->timer_deadline) >= ONE_SEC;
+#endif
+
+#if TIME_MODEL_TICKLESS
+    tickless_wakeup_schedule(p_server);
+    state_publish(p_server);
+#else
+    /* The next tick is due one second after this one was, so that a late handler does not shift the ticks */
+    p_server->timer_deadline = (p_server->timer_deadline + ONE_SEC) & APP_TIMER_MAX_CNT_VAL;
+    p_server->timer_active = true;
 
     time_state_update_time_delta(p_server, 1, 0);
+#endif
+#if TIME_MODEL_TRACE
+    if (trace) {
+        TIME_MODEL_TRACE_RECORD(TIME_MODEL_TRACE_TIMER, 0, TIME_MODEL_TRACE_SRC_LOCAL,
+                                previous_tai_seconds, p_server->server_state.tai_seconds);
+    }
+#endif
+}
+
+/** Serves all the time servers whose deadlines have passed, then restarts the timer for the next one */
+static void time_model_app_timer_cb(void * p_context) {
+    uint32_t now = app_timer_cnt_get();
+
+    m_timer_dispatching = true;
+    for (time_server_t * p_server = m_time_servers; p_server != NULL; p_server = p_server->p_next) {
+        if (p_server->timer_active && deadline_remaining_get(p_server->timer_deadline, now) == 0) {
+            p_server->timer_active = false;
+            time_model_timer_expire(p_server, now);
+        }
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+        if (p_server->pending_publish != 0 && deadline_remaining_get(p_server->publish_deadline, now) == 0) {
+            publish_holdoff_expire(p_server);
+        }
+#endif
+    }
+    m_timer_dispatching = false;
+
+    (void) shared_timer_restart();
+}
+
+/** Adds a time server to the ones driven by the shared timer, creating the timer with the first one */
+static uint32_t time_model_timer_add(time_server_t * p_server) {
+    time_server_t ** pp_next = &m_time_servers;
+    while (*pp_next != NULL) {
+        if (*pp_next == p_server) {
+            return NRF_SUCCESS;
+        }
+        pp_next = &(*pp_next)->p_next;
+    }
+
+    if (m_time_servers == NULL) {
+        uint32_t status = app_timer_create(&m_time_model_timer, APP_TIMER_MODE_SINGLE_SHOT, time_model_app_timer_cb);
+        if (status != NRF_SUCCESS) {
+            return status;
+        }
+    }
+
+    p_server->p_next = NULL;
+    p_server->timer_active = false;
+    *pp_next = p_server;
+    return NRF_SUCCESS;
 }
 #endif
 
@@ -95,20 +801,32 @@ uint32_t time_server_state_set_time(time_server_t * p_server, time_set_params_t
     }
 
 #if TIME_MODEL_USE_APP_TIMER
-    app_timer_stop(m_time_model_timer);
+    time_model_timer_stop(p_server);
 #endif   
-    p_server->server_state.tai_seconds = time_params->tai_seconds;
-    p_server->server_state.subsecond = time_params->subsecond;
-    p_server->server_state.uncertainty = time_params->uncertainty;
+    time_state_fp_set(&p_server->server_state, TIME_FP(time_params->tai_seconds, time_params->subsecond));
+    p_server->last_sync_time = TIME_FP(time_params->tai_seconds, time_params->subsecond);
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    frequency_discipline_reset(p_server);
+#endif
+    uncertainty_set(p_server, time_params->uncertainty, TIME_FP(time_params->tai_seconds, time_params->subsecond));
     p_server->server_state.time_authority = time_params->time_authority;
     p_server->server_state.time_zone_offset_current = time_params->time_zone_offset;
     p_server->server_state.tai_utc_delta_current = time_params->tai_utc_delta;
+    current_time_check_time_changes(p_server);
 #if TIME_MODEL_USE_APP_TIMER
-    app_timer_start(m_time_model_timer, ONE_SEC, p_server);
+    time_model_timer_start(p_server);
 #endif 
+    state_publish(p_server);
 
+#if TIME_MODEL_PERSISTENCE
+    state_save(p_server);
+#endif
     if (p_server->settings.publish_upon_state_change) {
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+	    return publish_holdoff_schedule(p_server, PENDING_PUBLISH_TIME_STATUS);
+#else
 	    return time_server_time_status_publish(p_server);
+#endif
     } else {
 	    return NRF_SUCCESS;
     }
@@ -128,9 +846,21 @@ uint32_t time_server_state_set_time_zone_offset(time_server_t * p_server, time_z
     
     p_server->server_state.time_zone_offset_new = time_zone_params->time_zone_offset_new;
     p_server->server_state.time_zone_change = time_zone_params->time_zone_change;
+    time_change_schedule(p_server, TIME_CHANGE_TIME_ZONE, time_zone_params->time_zone_change);
+#if TIME_MODEL_TICKLESS
+    tickless_wakeup_schedule(p_server);
+#endif
+    state_publish(p_server);
 
+#if TIME_MODEL_PERSISTENCE
+    state_save(p_server);
+#endif
     if (p_server->settings.publish_upon_state_change) {
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+	    return publish_holdoff_schedule(p_server, PENDING_PUBLISH_TIME_ZONE_STATUS);
+#else
 	    return time_server_time_zone_status_publish(p_server);
+#endif
     } else {
 	    return NRF_SUCCESS;
     } 
@@ -150,9 +880,21 @@ uint32_t time_server_state_set_tai_utc_delta(time_server_t * p_server, tai_utc_d
     
     p_server->server_state.tai_utc_delta_new = tai_utc_delta_params->tai_utc_delta_new;
     p_server->server_state.tai_utc_delta_change = tai_utc_delta_params->tai_utc_delta_change;
+    time_change_schedule(p_server, TIME_CHANGE_TAI_UTC_DELTA, tai_utc_delta_params->tai_utc_delta_change);
+#if TIME_MODEL_TICKLESS
+    tickless_wakeup_schedule(p_server);
+#endif
+    state_publish(p_server);
 
+#if TIME_MODEL_PERSISTENCE
+    state_save(p_server);
+#endif
     if (p_server->settings.publish_upon_state_change) {
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+	    return publish_holdoff_schedule(p_server, PENDING_PUBLISH_TAI_UTC_DELTA_STATUS);
+#else
 	    return time_server_tai_utc_delta_status_publish(p_server);
+#endif
     } else {
 	    return NRF_SUCCESS;
     }
@@ -175,9 +917,17 @@ uint32_t time_setup_server_state_set_time_role(time_setup_server_t * p_s_server,
     } else if (time_role_params->time_role == TIME_ROLE_CLIENT || time_role_params->time_role == TIME_ROLE_RELAY) {
 	    p_s_server->time_server.server_state.time_authority = false;
     }
+    state_publish(&p_s_server->time_server);
 
+#if TIME_MODEL_PERSISTENCE
+    state_save(&p_s_server->time_server);
+#endif
     if (p_s_server->settings.publish_upon_state_change) {
+#if TIME_MODEL_PUBLISH_HOLDOFF_MS
+	    return publish_holdoff_schedule(&p_s_server->time_server, PENDING_PUBLISH_TIME_ROLE_STATUS);
+#else
 	    return time_setup_server_time_role_status_publish(p_s_server);
+#endif
     } else {
 	    return NRF_SUCCESS;
     }
@@ -188,25 +938,33 @@ uint32_t time_setup_server_state_set_time_role(time_setup_server_t * p_s_server,
 **********************************************************************/
 
 static uint32_t time_status_send(const time_server_t * p_server, const access_message_rx_t * p_message) {
+    uint64_t tai_seconds;
+    uint8_t subsecond;
+    uint64_t current_time = current_time_get(p_server);
+    time_fp_round(current_time, &tai_seconds, &subsecond);
+
     time_status_msg_pkt_t msg_pkt = {
-	    .tai_seconds = p_server->server_state.tai_seconds,
+	    .tai_seconds = tai_seconds,
     };
     
     uint8_t msg_len;
-    if (p_server->server_state.tai_seconds == TAI_TIME_UNKNOWN) {
+    if (tai_seconds == TAI_TIME_UNKNOWN) {
 	    msg_len = TIME_STATUS_MINLEN;
     } else {
-        msg_pkt.subsecond = p_server->server_state.subsecond;
-        msg_pkt.uncertainty = p_server->server_state.uncertainty;
+        msg_pkt.subsecond = subsecond;
+        msg_pkt.uncertainty = current_uncertainty_get(p_server, current_time);
         msg_pkt.time_authority = p_server->server_state.time_authority;
         msg_pkt.time_zone_offset = time_zone_offset_encode(p_server->server_state.time_zone_offset_current);
         msg_pkt.tai_utc_delta = tai_utc_delta_encode(p_server->server_state.tai_utc_delta_current);
         msg_len = TIME_STATUS_MAXLEN;
     }
 
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    (void) time_status_msg_encode(&msg_pkt, buffer);
+
     access_message_tx_t reply = {
         .opcode = ACCESS_OPCODE_SIG(TIME_OPCODE_STATUS),
-        .p_buffer = (const uint8_t *) &msg_pkt,
+        .p_buffer = buffer,
         .length = msg_len,
         .force_segmented = p_server->settings.force_segmented,
         .transmic_size = p_server->settings.transmic_size
@@ -215,7 +973,7 @@ static uint32_t time_status_send(const time_server_t * p_server, const access_me
     if (p_message == NULL) {
 	    uint8_t previous_ttl;
 	    uint32_t status = NRF_SUCCESS;
-	if (p_server->server_state.tai_seconds == TAI_TIME_UNKNOWN) {
+	if (tai_seconds == TAI_TIME_UNKNOWN) {
 	    return NRF_ERROR_INVALID_STATE;
 	}
 	access_model_publish_ttl_get(p_server->model_handle, &previous_ttl);
@@ -223,12 +981,15 @@ static uint32_t time_status_send(const time_server_t * p_server, const access_me
 	status = access_model_publish_ttl_set(p_server->model_handle, TIME_STATUS_MSG_TTL);
 	if (status == NRF_SUCCESS) {
 	    status = access_model_publish(p_server->model_handle, &reply);
+	    TIME_MODEL_STATS_TX(TIME_OPCODE_STATUS, status);
 	}
 	access_model_publish_ttl_set(p_server->model_handle, previous_ttl);
 	return status;
     }
     else {
-        return access_model_reply(p_server->model_handle, p_message, &reply);
+        uint32_t status = access_model_reply(p_server->model_handle, p_message, &reply);
+        TIME_MODEL_STATS_TX(TIME_OPCODE_STATUS, status);
+        return status;
     }
 
 }
@@ -240,58 +1001,133 @@ static uint32_t time_zone_status_send(const time_server_t * p_server, const acce
         .time_zone_change = p_server->server_state.time_zone_change
     };
 
+    uint8_t buffer[TIME_ZONE_STATUS_LEN];
+    (void) time_model_msg_encode(&time_zone_status_msg_format, &msg_pkt, buffer);
+
     access_message_tx_t reply = {
         .opcode = ACCESS_OPCODE_SIG(TIME_OPCODE_ZONE_STATUS),
-        .p_buffer = (const uint8_t *) &msg_pkt,
+        .p_buffer = buffer,
         .length = TIME_ZONE_STATUS_LEN,
         .force_segmented = p_server->settings.force_segmented,
         .transmic_size = p_server->settings.transmic_size
     };
 
+    uint32_t status;
     if (p_message == NULL) {
-        return access_model_publish(p_server->model_handle, &reply);
+        status = access_model_publish(p_server->model_handle, &reply);
     }
     else {
-        return access_model_reply(p_server->model_handle, p_message, &reply);
+        status = access_model_reply(p_server->model_handle, p_message, &reply);
     }
+    TIME_MODEL_STATS_TX(TIME_OPCODE_ZONE_STATUS, status);
+    return status;
 }
 
 static uint32_t tai_utc_delta_status_send(const time_server_t * p_server, const access_message_rx_t * p_message) {
     tai_utc_delta_status_msg_pkt_t msg_pkt = {
         .tai_utc_delta_current = tai_utc_delta_encode(p_server->server_state.tai_utc_delta_current),
         .tai_utc_delta_new = tai_utc_delta_encode(p_server->server_state.tai_utc_delta_new),
-        .tai_utc_delta_change = p_server->server_state.tai_utc_delta_change,
-        .padding1 = 0,
-        .padding2 = 0
+        .tai_utc_delta_change = p_server->server_state.tai_utc_delta_change
     };
 
+    uint8_t buffer[TAI_UTC_DELTA_STATUS_LEN];
+    (void) time_model_msg_encode(&tai_utc_delta_status_msg_format, &msg_pkt, buffer);
+
     access_message_tx_t reply = {
         .opcode = ACCESS_OPCODE_SIG(TIME_OPCODE_TAI_UTC_DELTA_STATUS),
-        .p_buffer = (const uint8_t *) &msg_pkt,
+        .p_buffer = buffer,
         .length = TAI_UTC_DELTA_STATUS_LEN,
         .force_segmented = p_server->settings.force_segmented,
         .transmic_size = p_server->settings.transmic_size
     };
 
+    uint32_t status;
     if (p_message == NULL) {
-        return access_model_publish(p_server->model_handle, &reply);
+        status = access_model_publish(p_server->model_handle, &reply);
     }
     else {
-        return access_model_reply(p_server->model_handle, p_message, &reply);
+        status = access_model_reply(p_server->model_handle, p_message, &reply);
     }
+    TIME_MODEL_STATS_TX(TIME_OPCODE_TAI_UTC_DELTA_STATUS, status);
+    return status;
 }
 
 
 static void handle_time_get(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_server_t * p_server = (time_server_t *) p_args;
 
-    if (time_serv_callbacks.time_get_cb != NULL) {
-	    time_serv_callbacks.time_get_cb(p_server, &p_rx_msg->meta_data);
+    if (p_server->callbacks.time_get_cb != NULL) {
+	    p_server->callbacks.time_get_cb(p_server, &p_rx_msg->meta_data);
     }
 
     time_status_send(p_server, p_rx_msg);
 }
 
+#if TIME_STATUS_DEDUP_CACHE_SIZE
+/** Looks a received Time Status message up in the cache, and adds it if it was not there yet */
+static bool time_status_dedup_check(time_server_t * p_server, uint16_t src, const time_status_msg_pkt_t * p_msg_in) {
+    /* All the Time Status messages of an unknown time from a node have the same key, so they are never cached */
+    if (p_msg_in->tai_seconds == TAI_TIME_UNKNOWN) {
+        return false;
+    }
+
+    uint64_t tai_seconds = p_msg_in->tai_seconds;
+    uint32_t hash = ((uint32_t) src * 2654435761u) ^ (uint32_t) tai_seconds ^ ((uint32_t) p_msg_in->subsecond << 24);
+    time_status_dedup_entry_t * p_entry = &p_server->dedup_cache[(hash ^ (hash >> 16)) & (TIME_STATUS_DEDUP_CACHE_SIZE - 1)];
+
+    if (p_entry->src == src && p_entry->tai_seconds == tai_seconds && p_entry->subsecond == p_msg_in->subsecond) {
+        p_server->dedup_hits++;
+        return true;
+    }
+
+    p_entry->src = src;
+    p_entry->tai_seconds = tai_seconds;
+    p_entry->subsecond = p_msg_in->subsecond;
+    p_server->dedup_misses++;
+    return false;
+}
+#endif
+
+/** Uncertainty of a received time once the hop it took is accounted for */
+static uint8_t relay_uncertainty_get(uint8_t uncertainty) {
+    return (uncertainty > UINT8_MAX - TIME_MODEL_RELAY_HOP_UNCERTAINTY) ? UINT8_MAX : uncertainty + TIME_MODEL_RELAY_HOP_UNCERTAINTY;
+}
+
+/**
+ * Whether the time state should be synced to a received time. Any time is better than an unknown one, or
+ * than one which was never set nor synced to and which the clock may have counted up from the epoch, 
+ * otherwise the received time must be at least as accurate as the current one after its hop. Times that
+ * are only as accurate are refreshes from the same stratum, and the copies of one are ignored. A less
+ * accurate time is still taken once the current one has not been synced for TIME_MODEL_SYNC_MAX_AGE_S,
+ * e.g. after the authority restarted with a larger uncertainty. TIME CLIENT nodes do not relay, so they
+ * take any known time.
+ */
+static bool time_status_sync_check(const time_server_t * p_server, uint64_t sync_time, uint8_t sync_uncertainty) {
+    if ((sync_time >> TIME_FP_FRACTION_BITS) == TAI_TIME_UNKNOWN) {
+        return false;
+    }
+
+    uint64_t current_time = current_time_get(p_server);
+    if ((current_time >> TIME_FP_FRACTION_BITS) == TAI_TIME_UNKNOWN ||
+        (p_server->last_sync_time >> TIME_FP_FRACTION_BITS) == TAI_TIME_UNKNOWN) {
+        return true;
+    }
+
+    /* The time may have been set back since the last sync */
+    if (p_server->server_state.time_role == TIME_ROLE_CLIENT ||
+        (current_time > p_server->last_sync_time &&
+         current_time - p_server->last_sync_time >= (uint64_t) TIME_MODEL_SYNC_MAX_AGE_S * TIME_FP_ONE_SEC)) {
+        return true;
+    }
+
+    uint8_t current_uncertainty = current_uncertainty_get(p_server, current_time);
+    if (sync_uncertainty < current_uncertainty) {
+        return true;
+    }
+    return (sync_uncertainty == current_uncertainty && sync_uncertainty != UINT8_MAX &&
+            sync_time >= p_server->last_sync_time + (TIME_MODEL_RELAY_REFRESH_INTERVAL_MS * TIME_FP_ONE_SEC) / 1000);
+}
+
 static void handle_time_status(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_server_t * p_server = (time_server_t *) p_args;
     
@@ -310,22 +1146,58 @@ static void handle_time_status(access_model_handle_t model_handle, const access_
 	    return;
     }
 
-#if TIME_MODEL_USE_APP_TIMER
-    app_timer_stop(m_time_model_timer);
-#endif    
-    time_status_msg_pkt_t * p_msg_in = (time_status_msg_pkt_t *) p_rx_msg->p_data;
+    /* The fields after the TAI seconds are left out when, and only when, the time is unknown, Section 5.2.1.3 */
+    time_status_msg_pkt_t msg_in;
+    time_status_msg_decode(p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    if (p_rx_msg->length < TIME_STATUS_MAXLEN && msg_in.tai_seconds != TAI_TIME_UNKNOWN) {
+        return;
+    }
+    const time_status_msg_pkt_t * p_msg_in = &msg_in;
 
-    p_server->server_state.tai_seconds = p_msg_in->tai_seconds;
-    p_server->server_state.subsecond = p_msg_in->subsecond;
-    p_server->server_state.uncertainty = p_msg_in->uncertainty;
-    p_server->server_state.time_zone_offset_current = time_zone_offset_decode(p_msg_in->time_zone_offset);
-    p_server->server_state.tai_utc_delta_current = tai_utc_delta_decode(p_msg_in->tai_utc_delta);
-    current_time_check_time_changes(p_server);
+#if TIME_STATUS_DEDUP_CACHE_SIZE
+    if (time_status_dedup_check(p_server, p_rx_msg->meta_data.src.value, p_msg_in)) {
+        return;
+    }
+#endif
+
+    uint64_t sync_time = TIME_FP(p_msg_in->tai_seconds, p_msg_in->subsecond);
+#if TIME_MODEL_DELAY_COMPENSATION
+    if (p_msg_in->tai_seconds != TAI_TIME_UNKNOWN) {
+        sync_time += rx_delay_get(p_rx_msg);
+    }
+#endif
+    uint8_t sync_uncertainty = relay_uncertainty_get(p_msg_in->uncertainty);
+    bool sync = time_status_sync_check(p_server, sync_time, sync_uncertainty);
+    TIME_MODEL_TRACE_RECORD(sync ? TIME_MODEL_TRACE_TIME_STATUS_SYNC : TIME_MODEL_TRACE_TIME_STATUS,
+                            p_msg_in->uncertainty, p_rx_msg->meta_data.src.value,
+                            current_time_get(p_server) >> TIME_FP_FRACTION_BITS, p_msg_in->tai_seconds);
+
+    if (sync) {
 #if TIME_MODEL_USE_APP_TIMER
-    app_timer_start(m_time_model_timer, ONE_SEC, p_server);
-#endif 
+        time_model_timer_stop(p_server);
+#endif
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+        uint64_t local_time = current_time_get(p_server);
+        if ((local_time >> TIME_FP_FRACTION_BITS) != TAI_TIME_UNKNOWN) {
+            frequency_discipline_update(p_server, local_time, sync_time);
+        }
+#endif
+        time_state_fp_set(&p_server->server_state, sync_time);
+        uncertainty_set(p_server, sync_uncertainty, sync_time);
+        p_server->server_state.time_zone_offset_current = time_zone_offset_decode(p_msg_in->time_zone_offset);
+        p_server->server_state.tai_utc_delta_current = tai_utc_delta_decode(p_msg_in->tai_utc_delta);
+        p_server->last_sync_time = sync_time;
+        current_time_check_time_changes(p_server);
+#if TIME_MODEL_USE_APP_TIMER
+        time_model_timer_start(p_server);
+#endif
+        state_publish(p_server);
+#if TIME_MODEL_PERSISTENCE
+        state_save_on_sync(p_server, sync_time);
+#endif
+    }
 
-    if (time_serv_callbacks.time_status_cb != NULL) {
+    if (p_server->callbacks.time_status_cb != NULL) {
         time_status_params_t in_data;
         in_data.tai_seconds = p_msg_in->tai_seconds;
         in_data.subsecond = p_msg_in->subsecond;
@@ -333,10 +1205,10 @@ static void handle_time_status(access_model_handle_t model_handle, const access_
         in_data.time_zone_offset = time_zone_offset_decode(p_msg_in->time_zone_offset);
         in_data.tai_utc_delta = tai_utc_delta_decode(p_msg_in->tai_utc_delta);
 
-        time_serv_callbacks.time_status_cb(p_server, &p_rx_msg->meta_data, &in_data);
+        p_server->callbacks.time_status_cb(p_server, &p_rx_msg->meta_data, &in_data);
     }
 
-    if (p_server->server_state.time_role == TIME_ROLE_RELAY) {
+    if (sync && p_server->server_state.time_role == TIME_ROLE_RELAY) {
 	/* 
 	    Extra thing that may or may not go against the specification:
 
@@ -346,15 +1218,18 @@ static void handle_time_status(access_model_handle_t model_handle, const access_
 	    with each other which can caused an infinte relay of messages between multiple
 	    TIME RELAY nodes. 
 
-	    To prevent this issue, my implementation makes it so that a time server with the role of TIME RELAY
-	    should only relay messages that have the time authority field set to TRUE, and enforce
-	    that all TIME RELAY nodes have their own time authority state set to false. This way, 
-	    a TIME RELAY node will never relay the message sent from another TIME RELAY node in order
-	    to prevent this infinte relaying
+	    To prevent this issue, my implementation uses the uncertainty of a time as its
+	    stratum: every hop adds TIME_MODEL_RELAY_HOP_UNCERTAINTY to it, and a node only
+	    syncs to a time that is at least as accurate as its own (see time_status_sync_check).
+	    A relayed time is therefore always worse than the one it was relayed from and can never
+	    be relayed back, while it still crosses any number of TIME RELAY nodes in a single
+	    pass. A time that has reached the maximum uncertainty is no longer relayed.
 	*/
-	if (p_msg_in->time_authority) {
+	if (p_server->server_state.uncertainty != UINT8_MAX) {
 	    p_server->server_state.time_authority = false;
-	    time_status_send(p_server, NULL);
+	    if (time_status_send(p_server, NULL) == NRF_SUCCESS) {
+	        TIME_MODEL_STATS_RELAY();
+	    }
 	}
     }
 }
@@ -362,8 +1237,8 @@ static void handle_time_status(access_model_handle_t model_handle, const access_
 static void handle_time_zone_get(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_server_t * p_server = (time_server_t *) p_args;
     
-    if (time_serv_callbacks.time_zone_get_cb != NULL) {
-	    time_serv_callbacks.time_zone_get_cb(p_server, &p_rx_msg->meta_data);
+    if (p_server->callbacks.time_zone_get_cb != NULL) {
+	    p_server->callbacks.time_zone_get_cb(p_server, &p_rx_msg->meta_data);
     }
 
     time_zone_status_send(p_server, p_rx_msg);
@@ -372,25 +1247,31 @@ static void handle_time_zone_get(access_model_handle_t model_handle, const acces
 static void handle_tai_utc_delta_get(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_server_t * p_server = (time_server_t *) p_args;
     
-    if (time_serv_callbacks.tai_utc_delta_get_cb != NULL) {
-	    time_serv_callbacks.tai_utc_delta_get_cb(p_server, &p_rx_msg->meta_data);
+    if (p_server->callbacks.tai_utc_delta_get_cb != NULL) {
+	    p_server->callbacks.tai_utc_delta_get_cb(p_server, &p_rx_msg->meta_data);
     }
 
     tai_utc_delta_status_send(p_server, p_rx_msg);
 }
 
+/** Messages handled by the Time Server, with their minimum and maximum payload lengths */
+#define TIME_SERVER_OPCODES(X)                                                                           \
+    X(TIME_OPCODE_GET, handle_time_get, TIME_MODEL_GET_LEN, TIME_MODEL_GET_LEN)                          \
+    X(TIME_OPCODE_STATUS, handle_time_status, TIME_STATUS_MINLEN, TIME_STATUS_MAXLEN)                   \
+    X(TIME_OPCODE_ZONE_GET, handle_time_zone_get, TIME_MODEL_GET_LEN, TIME_MODEL_GET_LEN)                \
+    X(TIME_OPCODE_TAI_UTC_DELTA_GET, handle_tai_utc_delta_get, TIME_MODEL_GET_LEN, TIME_MODEL_GET_LEN)
+
+TIME_SERVER_OPCODES(TIME_MODEL_OPCODE_HANDLER_DEFINE)
+
 static const access_opcode_handler_t m_opcode_handlers_server[] = {
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_GET), handle_time_get},
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_STATUS), handle_time_status},
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_ZONE_GET), handle_time_zone_get},
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_TAI_UTC_DELTA_GET), handle_tai_utc_delta_get},
+    TIME_SERVER_OPCODES(TIME_MODEL_OPCODE_TABLE_ENTRY)
 };
 
 static void periodic_publish_serv_cb(access_model_handle_t handle, void * p_args) {
     time_server_t * p_server = (time_server_t *) p_args;
     
-    if (time_serv_callbacks.time_get_cb != NULL) {
-	    time_serv_callbacks.time_get_cb(p_server, NULL);
+    if (p_server->callbacks.time_get_cb != NULL) {
+	    p_server->callbacks.time_get_cb(p_server, NULL);
     }
 
     time_status_send(p_server, NULL);
@@ -412,6 +1293,15 @@ static uint32_t time_server_init(time_server_t * p_server, uint8_t element_index
         .publish_timeout_cb = periodic_publish_serv_cb
     };
 
+    /* Changes already in the initial state are queued like the ones set later */
+    p_server->pending_change_count = 0;
+    time_change_schedule(p_server, TIME_CHANGE_TIME_ZONE, p_server->server_state.time_zone_change);
+    time_change_schedule(p_server, TIME_CHANGE_TAI_UTC_DELTA, p_server->server_state.tai_utc_delta_change);
+#if TIME_MODEL_STATE_SNAPSHOT
+    p_server->state_seq = 0;
+#endif
+    state_publish(p_server);
+
     status = access_model_add(&init_params, &p_server->model_handle);
     if (status == NRF_SUCCESS) {
 	    status = access_model_subscription_list_alloc(p_server->model_handle);
@@ -421,8 +1311,13 @@ static uint32_t time_server_init(time_server_t * p_server, uint8_t element_index
 
 }
 
-void time_server_set_callbacks(time_server_callbacks_t * p_callbacks) {
-    memcpy(&time_serv_callbacks, p_callbacks, sizeof(time_server_callbacks_t));
+uint32_t time_server_set_callbacks(time_server_t * p_server, const time_server_callbacks_t * p_callbacks) {
+    if (p_server == NULL || p_callbacks == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    memcpy(&p_server->callbacks, p_callbacks, sizeof(time_server_callbacks_t));
+    return NRF_SUCCESS;
 }
 
 uint32_t time_server_time_status_publish(const time_server_t * p_server) {
@@ -446,6 +1341,18 @@ uint32_t time_server_tai_utc_delta_status_publish(const time_server_t * p_server
     return tai_utc_delta_status_send(p_server, NULL);
 }
 
+#if TIME_STATUS_DEDUP_CACHE_SIZE
+uint32_t time_server_dedup_stats_get(const time_server_t * p_server, uint32_t * p_hits, uint32_t * p_misses) {
+    if (p_server == NULL || p_hits == NULL || p_misses == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    *p_hits = p_server->dedup_hits;
+    *p_misses = p_server->dedup_misses;
+    return NRF_SUCCESS;
+}
+#endif
+
 
 /********************************************************************* 
     TIME SETUP SERVER IMPLEMENTATION
@@ -455,40 +1362,58 @@ static uint32_t time_role_status_send(const time_setup_server_t * p_s_server, co
 	    .time_role = p_s_server->time_server.server_state.time_role
     };
 
+    uint8_t buffer[TIME_ROLE_STATUS_LEN];
+    (void) time_model_msg_encode(&time_role_status_msg_format, &msg_pkt, buffer);
+
     access_message_tx_t reply = {
         .opcode = ACCESS_OPCODE_SIG(TIME_OPCODE_ROLE_STATUS),
-        .p_buffer = (const uint8_t *) &msg_pkt,
+        .p_buffer = buffer,
         .length = TIME_ROLE_STATUS_LEN,
         .force_segmented = p_s_server->settings.force_segmented,
         .transmic_size = p_s_server->settings.transmic_size
     };
 
+    uint32_t status;
     if (p_message == NULL) {
-        return access_model_publish(p_s_server->model_handle, &reply);
+        status = access_model_publish(p_s_server->model_handle, &reply);
     }
     else {
-        return access_model_reply(p_s_server->model_handle, p_message, &reply);
+        status = access_model_reply(p_s_server->model_handle, p_message, &reply);
     }
+    TIME_MODEL_STATS_TX(TIME_OPCODE_ROLE_STATUS, status);
+    return status;
 
 }
 
 static void handle_time_set(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_setup_server_t * p_s_server = (time_setup_server_t *) p_args;
     
-    time_set_msg_pkt_t * p_msg_in = (time_set_msg_pkt_t *) p_rx_msg->p_data;
+    time_set_msg_pkt_t msg_in;
+    time_model_msg_decode(&time_set_msg_format, p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    const time_set_msg_pkt_t * p_msg_in = &msg_in;
+    TIME_MODEL_TRACE_RECORD(TIME_MODEL_TRACE_TIME_SET, p_msg_in->uncertainty, p_rx_msg->meta_data.src.value,
+                            current_time_get(&p_s_server->time_server) >> TIME_FP_FRACTION_BITS, p_msg_in->tai_seconds);
 
 #if TIME_MODEL_USE_APP_TIMER
-    app_timer_stop(m_time_model_timer);
+    time_model_timer_stop(&p_s_server->time_server);
 #endif    
-    p_s_server->time_server.server_state.tai_seconds = p_msg_in->tai_seconds;
-    p_s_server->time_server.server_state.subsecond = p_msg_in->subsecond;
-    p_s_server->time_server.server_state.uncertainty = p_msg_in->uncertainty;
+    time_state_fp_set(&p_s_server->time_server.server_state, TIME_FP(p_msg_in->tai_seconds, p_msg_in->subsecond));
+    p_s_server->time_server.last_sync_time = TIME_FP(p_msg_in->tai_seconds, p_msg_in->subsecond);
+#if TIME_MODEL_FREQUENCY_DISCIPLINE
+    frequency_discipline_reset(&p_s_server->time_server);
+#endif
+    uncertainty_set(&p_s_server->time_server, p_msg_in->uncertainty, TIME_FP(p_msg_in->tai_seconds, p_msg_in->subsecond));
     p_s_server->time_server.server_state.time_zone_offset_current = time_zone_offset_decode(p_msg_in->time_zone_offset);
     p_s_server->time_server.server_state.tai_utc_delta_current = tai_utc_delta_decode(p_msg_in->tai_utc_delta);
+    current_time_check_time_changes(&p_s_server->time_server);
 #if TIME_MODEL_USE_APP_TIMER
-    app_timer_start(m_time_model_timer, ONE_SEC, &p_s_server->time_server);
+    time_model_timer_start(&p_s_server->time_server);
 #endif    
-    if (time_setup_serv_callbacks.time_set_cb != NULL) {
+    state_publish(&p_s_server->time_server);
+#if TIME_MODEL_PERSISTENCE
+    state_save(&p_s_server->time_server);
+#endif
+    if (p_s_server->callbacks.time_set_cb != NULL) {
         time_set_params_t in_data;
         in_data.tai_seconds = p_msg_in->tai_seconds;
         in_data.subsecond = p_msg_in->subsecond;
@@ -496,7 +1421,7 @@ static void handle_time_set(access_model_handle_t model_handle, const access_mes
         in_data.time_zone_offset = time_zone_offset_decode(p_msg_in->time_zone_offset);
         in_data.tai_utc_delta = tai_utc_delta_decode(p_msg_in->tai_utc_delta);
 
-        time_setup_serv_callbacks.time_set_cb(p_s_server, &p_rx_msg->meta_data, &in_data);
+        p_s_server->callbacks.time_set_cb(p_s_server, &p_rx_msg->meta_data, &in_data);
     }
 
     time_status_send(&p_s_server->time_server, p_rx_msg);
@@ -505,16 +1430,26 @@ static void handle_time_set(access_model_handle_t model_handle, const access_mes
 static void handle_time_zone_set(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_setup_server_t * p_s_server = (time_setup_server_t *) p_args;
 
-    time_zone_set_msg_pkt_t * p_msg_in = (time_zone_set_msg_pkt_t *) p_rx_msg->p_data;
+    time_zone_set_msg_pkt_t msg_in;
+    time_model_msg_decode(&time_zone_set_msg_format, p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    const time_zone_set_msg_pkt_t * p_msg_in = &msg_in;
 
     p_s_server->time_server.server_state.time_zone_offset_new = time_zone_offset_decode(p_msg_in->time_zone_offset_new);
     p_s_server->time_server.server_state.time_zone_change = p_msg_in->time_zone_change;
-    if (time_setup_serv_callbacks.time_zone_set_cb != NULL) {
+    time_change_schedule(&p_s_server->time_server, TIME_CHANGE_TIME_ZONE, p_msg_in->time_zone_change);
+#if TIME_MODEL_TICKLESS
+    tickless_wakeup_schedule(&p_s_server->time_server);
+#endif
+    state_publish(&p_s_server->time_server);
+#if TIME_MODEL_PERSISTENCE
+    state_save(&p_s_server->time_server);
+#endif
+    if (p_s_server->callbacks.time_zone_set_cb != NULL) {
         time_zone_set_params_t in_data;
         in_data.time_zone_offset_new = time_zone_offset_decode(p_msg_in->time_zone_offset_new);
         in_data.time_zone_change = p_msg_in->time_zone_change;
 
-        time_setup_serv_callbacks.time_zone_set_cb(p_s_server, &p_rx_msg->meta_data, &in_data);
+        p_s_server->callbacks.time_zone_set_cb(p_s_server, &p_rx_msg->meta_data, &in_data);
     }
 
     time_zone_status_send(&p_s_server->time_server, p_rx_msg);
@@ -523,16 +1458,26 @@ static void handle_time_zone_set(access_model_handle_t model_handle, const acces
 static void handle_tai_utc_delta_set(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_setup_server_t * p_s_server = (time_setup_server_t *) p_args;
 
-    tai_utc_delta_set_msg_pkt_t * p_msg_in = (tai_utc_delta_set_msg_pkt_t *) p_rx_msg->p_data;
+    tai_utc_delta_set_msg_pkt_t msg_in;
+    time_model_msg_decode(&tai_utc_delta_set_msg_format, p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    const tai_utc_delta_set_msg_pkt_t * p_msg_in = &msg_in;
 
     p_s_server->time_server.server_state.tai_utc_delta_new = tai_utc_delta_decode(p_msg_in->tai_utc_delta_new);
     p_s_server->time_server.server_state.tai_utc_delta_change = p_msg_in->tai_utc_delta_change;
-    if (time_setup_serv_callbacks.tai_utc_delta_set_cb != NULL) {
+    time_change_schedule(&p_s_server->time_server, TIME_CHANGE_TAI_UTC_DELTA, p_msg_in->tai_utc_delta_change);
+#if TIME_MODEL_TICKLESS
+    tickless_wakeup_schedule(&p_s_server->time_server);
+#endif
+    state_publish(&p_s_server->time_server);
+#if TIME_MODEL_PERSISTENCE
+    state_save(&p_s_server->time_server);
+#endif
+    if (p_s_server->callbacks.tai_utc_delta_set_cb != NULL) {
         tai_utc_delta_set_params_t in_data;
         in_data.tai_utc_delta_new = tai_utc_delta_decode(p_msg_in->tai_utc_delta_new);
         in_data.tai_utc_delta_change = p_msg_in->tai_utc_delta_change;
 
-        time_setup_serv_callbacks.tai_utc_delta_set_cb(p_s_server, &p_rx_msg->meta_data, &in_data);
+        p_s_server->callbacks.tai_utc_delta_set_cb(p_s_server, &p_rx_msg->meta_data, &in_data);
     }
 
     tai_utc_delta_status_send(&p_s_server->time_server, p_rx_msg);
@@ -541,8 +1486,8 @@ static void handle_tai_utc_delta_set(access_model_handle_t model_handle, const a
 static void handle_time_role_get(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_setup_server_t * p_s_server = (time_setup_server_t *) p_args;
 
-    if (time_setup_serv_callbacks.time_role_get_cb != NULL) {
-	    time_setup_serv_callbacks.time_role_get_cb(p_s_server, &p_rx_msg->meta_data);
+    if (p_s_server->callbacks.time_role_get_cb != NULL) {
+	    p_s_server->callbacks.time_role_get_cb(p_s_server, &p_rx_msg->meta_data);
     }
 
     time_role_status_send(p_s_server, p_rx_msg);
@@ -551,7 +1496,11 @@ static void handle_time_role_get(access_model_handle_t model_handle, const acces
 static void handle_time_role_set(access_model_handle_t model_handle, const access_message_rx_t * p_rx_msg, void * p_args) {
     time_setup_server_t * p_s_server = (time_setup_server_t *) p_args;
     
-    time_role_set_msg_pkt_t * p_msg_in = (time_role_set_msg_pkt_t *) p_rx_msg->p_data;
+    time_role_set_msg_pkt_t msg_in;
+    time_model_msg_decode(&time_role_set_msg_format, p_rx_msg->p_data, p_rx_msg->length, &msg_in);
+    const time_role_set_msg_pkt_t * p_msg_in = &msg_in;
+    TIME_MODEL_TRACE_RECORD(TIME_MODEL_TRACE_ROLE_SET, 0, p_rx_msg->meta_data.src.value,
+                            p_s_server->time_server.server_state.time_role, p_msg_in->time_role);
 
     p_s_server->time_server.server_state.time_role = p_msg_in->time_role;
     /* Extra thing not explicitly stated in spec: If the Time Role is not an authority, 
@@ -563,24 +1512,34 @@ static void handle_time_role_set(access_model_handle_t model_handle, const acces
     } else if (p_msg_in->time_role == TIME_ROLE_CLIENT || p_msg_in->time_role == TIME_ROLE_RELAY) {
 	    p_s_server->time_server.server_state.time_authority = false;
     }
+    state_publish(&p_s_server->time_server);
 
-    if (time_setup_serv_callbacks.time_role_set_cb != NULL) {
+#if TIME_MODEL_PERSISTENCE
+    state_save(&p_s_server->time_server);
+#endif
+    if (p_s_server->callbacks.time_role_set_cb != NULL) {
 	time_role_set_params_t in_data = {
 	    .time_role = p_msg_in->time_role
 	};  
 	
-	time_setup_serv_callbacks.time_role_set_cb(p_s_server, &p_rx_msg->meta_data, &in_data);
+	p_s_server->callbacks.time_role_set_cb(p_s_server, &p_rx_msg->meta_data, &in_data);
     }
 
     time_role_status_send(p_s_server, p_rx_msg);
 }
 
+/** Messages handled by the Time Setup Server, with their minimum and maximum payload lengths */
+#define TIME_SETUP_SERVER_OPCODES(X)                                                                     \
+    X(TIME_OPCODE_SET, handle_time_set, TIME_SET_LEN, TIME_SET_LEN)                                      \
+    X(TIME_OPCODE_ZONE_SET, handle_time_zone_set, TIME_ZONE_SET_LEN, TIME_ZONE_SET_LEN)                  \
+    X(TIME_OPCODE_TAI_UTC_DELTA_SET, handle_tai_utc_delta_set, TAI_UTC_DELTA_SET_LEN, TAI_UTC_DELTA_SET_LEN) \
+    X(TIME_OPCODE_ROLE_GET, handle_time_role_get, TIME_MODEL_GET_LEN, TIME_MODEL_GET_LEN)                \
+    X(TIME_OPCODE_ROLE_SET, handle_time_role_set, TIME_ROLE_SET_LEN, TIME_ROLE_SET_LEN)
+
+TIME_SETUP_SERVER_OPCODES(TIME_MODEL_OPCODE_HANDLER_DEFINE)
+
 static const access_opcode_handler_t m_opcode_handlers_setup_server[] = {
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_SET), handle_time_set},
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_ZONE_SET), handle_time_zone_set},
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_TAI_UTC_DELTA_SET), handle_tai_utc_delta_set},
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_ROLE_GET), handle_time_role_get},
-    {ACCESS_OPCODE_SIG(TIME_OPCODE_ROLE_SET), handle_time_role_set},
+    TIME_SETUP_SERVER_OPCODES(TIME_MODEL_OPCODE_TABLE_ENTRY)
 };
 
 uint32_t time_setup_server_init(time_setup_server_t * p_s_server, uint8_t element_index) {
@@ -609,18 +1568,31 @@ uint32_t time_setup_server_init(time_setup_server_t * p_s_server, uint8_t elemen
     };
 
     status = access_model_add(&init_params, &p_s_server->model_handle);
+#if TIME_MODEL_PERSISTENCE
+    if (status == NRF_SUCCESS) {
+	    state_restore(&p_s_server->time_server);
+    }
+#endif
 #if TIME_MODEL_USE_APP_TIMER
     if (status == NRF_SUCCESS) {
-	    status = app_timer_create(&m_time_model_timer, APP_TIMER_MODE_REPEATED, time_model_app_timer_cb);
-	    app_timer_start(m_time_model_timer, ONE_SEC, (void *) &p_s_server->time_server);
+	    status = time_model_timer_add(&p_s_server->time_server);
+    }
+    if (status == NRF_SUCCESS) {
+	    time_model_timer_start(&p_s_server->time_server);
     }
 #endif
+    state_publish(&p_s_server->time_server);
     return status;
 }
 
 
-void time_setup_server_set_callbacks(time_setup_server_callbacks_t * p_callbacks) {
-    memcpy(&time_setup_serv_callbacks, p_callbacks, sizeof(time_setup_server_callbacks_t));
+uint32_t time_setup_server_set_callbacks(time_setup_server_t * p_s_server, const time_setup_server_callbacks_t * p_callbacks) {
+    if (p_s_server == NULL || p_callbacks == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    memcpy(&p_s_server->callbacks, p_callbacks, sizeof(time_setup_server_callbacks_t));
+    return NRF_SUCCESS;
 }
 
 uint32_t time_setup_server_time_role_status_publish(const time_setup_server_t * p_s_server) {
@@ -0,0 +1,97 @@
+#include "time_model_stats.h"
+
+#if TIME_MODEL_STATS
+
+#include <stdint.h>
+#include <string.h>
+
+#include "nrf_mesh.h"
+#include "time_model_messages.h"
+
+static time_model_stats_t m_stats;
+
+time_model_stats_opcode_t time_model_stats_opcode_index(uint16_t opcode) {
+    switch (opcode) {
+        case TIME_OPCODE_GET:
+            return TIME_MODEL_STATS_OPCODE_GET;
+        case TIME_OPCODE_SET:
+            return TIME_MODEL_STATS_OPCODE_SET;
+        case TIME_OPCODE_STATUS:
+            return TIME_MODEL_STATS_OPCODE_STATUS;
+        case TIME_OPCODE_ROLE_GET:
+            return TIME_MODEL_STATS_OPCODE_ROLE_GET;
+        case TIME_OPCODE_ROLE_SET:
+            return TIME_MODEL_STATS_OPCODE_ROLE_SET;
+        case TIME_OPCODE_ROLE_STATUS:
+            return TIME_MODEL_STATS_OPCODE_ROLE_STATUS;
+        case TIME_OPCODE_ZONE_GET:
+            return TIME_MODEL_STATS_OPCODE_ZONE_GET;
+        case TIME_OPCODE_ZONE_SET:
+            return TIME_MODEL_STATS_OPCODE_ZONE_SET;
+        case TIME_OPCODE_ZONE_STATUS:
+            return TIME_MODEL_STATS_OPCODE_ZONE_STATUS;
+        case TIME_OPCODE_TAI_UTC_DELTA_GET:
+            return TIME_MODEL_STATS_OPCODE_TAI_UTC_DELTA_GET;
+        case TIME_OPCODE_TAI_UTC_DELTA_SET:
+            return TIME_MODEL_STATS_OPCODE_TAI_UTC_DELTA_SET;
+        case TIME_OPCODE_TAI_UTC_DELTA_STATUS:
+            return TIME_MODEL_STATS_OPCODE_TAI_UTC_DELTA_STATUS;
+        default:
+            return TIME_MODEL_STATS_OPCODE_COUNT;
+    }
+}
+
+/** Bucket of a latency: the number of significant bits of it, capped to the last bucket */
+static uint32_t latency_bucket_get(uint32_t latency_us) {
+    uint32_t bucket = (latency_us == 0) ? 0 : 32 - __builtin_clz(latency_us);
+    return (bucket < TIME_MODEL_STATS_LATENCY_BUCKETS) ? bucket : TIME_MODEL_STATS_LATENCY_BUCKETS - 1;
+}
+
+void time_model_stats_rx(uint16_t opcode, uint32_t latency_us) {
+    time_model_stats_opcode_t index = time_model_stats_opcode_index(opcode);
+    if (index == TIME_MODEL_STATS_OPCODE_COUNT) {
+        return;
+    }
+
+    m_stats.opcodes[index].rx_count++;
+    m_stats.opcodes[index].latency_histogram[latency_bucket_get(latency_us)]++;
+}
+
+void time_model_stats_rx_invalid(uint16_t opcode) {
+    time_model_stats_opcode_t index = time_model_stats_opcode_index(opcode);
+    if (index != TIME_MODEL_STATS_OPCODE_COUNT) {
+        m_stats.opcodes[index].rx_invalid_count++;
+    }
+}
+
+void time_model_stats_tx(uint16_t opcode, uint32_t status) {
+    time_model_stats_opcode_t index = time_model_stats_opcode_index(opcode);
+    if (index == TIME_MODEL_STATS_OPCODE_COUNT) {
+        return;
+    }
+
+    if (status == NRF_SUCCESS) {
+        m_stats.opcodes[index].tx_count++;
+        return;
+    }
+
+    m_stats.opcodes[index].tx_error_count++;
+    uint32_t code = status - NRF_ERROR_BASE_NUM;
+    m_stats.error_counts[(code < TIME_MODEL_STATS_ERROR_CODE_COUNT) ? code : 0]++;
+}
+
+void time_model_stats_relay(void) {
+    m_stats.relay_count++;
+}
+
+void time_model_stats_snapshot(time_model_stats_t * p_snapshot) {
+    if (p_snapshot != NULL) {
+        memcpy(p_snapshot, &m_stats, sizeof(m_stats));
+    }
+}
+
+void time_model_stats_reset(void) {
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+#endif
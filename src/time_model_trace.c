@@ -0,0 +1,130 @@
+#include "time_model_trace.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#if TIME_MODEL_TRACE
+#include <string.h>
+
+#include "timer.h"
+
+#define TRACE_INDEX(count) ((count) & (TIME_MODEL_TRACE_SIZE - 1))
+
+static time_model_trace_record_t m_trace[TIME_MODEL_TRACE_SIZE];
+/** Number of records written, only moved by the producer */
+static uint32_t m_head;
+/** Number of records drained or lost, only moved by the drain */
+static uint32_t m_tail;
+/** Records lost since the previous drain */
+static uint32_t m_lost;
+
+void time_model_trace_record(uint8_t event, uint8_t detail, uint16_t src, uint32_t old_value, uint32_t new_value) {
+    uint32_t head = m_head;
+    time_model_trace_record_t * p_record = &m_trace[TRACE_INDEX(head)];
+
+    p_record->timestamp = timer_now();
+    p_record->event = event;
+    p_record->detail = detail;
+    p_record->src = src;
+    p_record->old_value = old_value;
+    p_record->new_value = new_value;
+
+    __atomic_store_n(&m_head, head + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t time_model_trace_drain(time_model_trace_record_t * p_records, uint32_t max_count, uint32_t * p_lost) {
+    if (p_records == NULL) {
+        return 0;
+    }
+
+    uint32_t head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    if (head - m_tail > TIME_MODEL_TRACE_SIZE) {
+        m_lost += head - m_tail - TIME_MODEL_TRACE_SIZE;
+        m_tail = head - TIME_MODEL_TRACE_SIZE;
+    }
+
+    uint32_t count = head - m_tail;
+    if (count > max_count) {
+        count = max_count;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        p_records[i] = m_trace[TRACE_INDEX(m_tail + i)];
+    }
+
+    /* 
+        A record may have been overwritten while it was copied. The producer writes record head to the
+        slot of record head - TIME_MODEL_TRACE_SIZE before moving the head past it, so only the records
+        less than TIME_MODEL_TRACE_SIZE behind the head are known to be intact.
+    */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    head = __atomic_load_n(&m_head, __ATOMIC_ACQUIRE);
+    uint32_t overwritten = 0;
+    while (overwritten < count && head - (m_tail + overwritten) >= TIME_MODEL_TRACE_SIZE) {
+        overwritten++;
+    }
+    if (overwritten > 0) {
+        count -= overwritten;
+        memmove(&p_records[0], &p_records[overwritten], count * sizeof(time_model_trace_record_t));
+        m_lost += overwritten;
+    }
+    m_tail += overwritten + count;
+
+    if (p_lost != NULL) {
+        *p_lost = m_lost;
+    }
+    m_lost = 0;
+    return count;
+}
+#endif
+
+const char * time_model_trace_event_name(uint8_t event) {
+    switch (event) {
+        case TIME_MODEL_TRACE_TIME_STATUS:
+            return "TIME_STATUS";
+        case TIME_MODEL_TRACE_TIME_STATUS_SYNC:
+            return "TIME_STATUS_SYNC";
+        case TIME_MODEL_TRACE_TIME_SET:
+            return "TIME_SET";
+        case TIME_MODEL_TRACE_ROLE_SET:
+            return "ROLE_SET";
+        case TIME_MODEL_TRACE_TIME_CHANGE:
+            return "TIME_CHANGE";
+        case TIME_MODEL_TRACE_TIMER:
+            return "TIMER";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+int time_model_trace_record_format(const time_model_trace_record_t * p_record, char * p_buffer, size_t size) {
+    const char * p_name = time_model_trace_event_name(p_record->event);
+
+    switch (p_record->event) {
+        case TIME_MODEL_TRACE_TIME_STATUS:
+        case TIME_MODEL_TRACE_TIME_STATUS_SYNC:
+        case TIME_MODEL_TRACE_TIME_SET:
+            return snprintf(p_buffer, size, "%10lu us %s src 0x%04x tai %lu -> %lu uncertainty %u",
+                            (unsigned long) p_record->timestamp, p_name, p_record->src,
+                            (unsigned long) p_record->old_value, (unsigned long) p_record->new_value,
+                            p_record->detail);
+        case TIME_MODEL_TRACE_ROLE_SET:
+            return snprintf(p_buffer, size, "%10lu us %s src 0x%04x role %lu -> %lu",
+                            (unsigned long) p_record->timestamp, p_name, p_record->src,
+                            (unsigned long) p_record->old_value, (unsigned long) p_record->new_value);
+        case TIME_MODEL_TRACE_TIME_CHANGE:
+            /* The Time Zone Offset and TAI-UTC Delta states are signed */
+            return snprintf(p_buffer, size, "%10lu us %s type %u %ld -> %ld",
+                            (unsigned long) p_record->timestamp, p_name, p_record->detail,
+                            (long) (int32_t) p_record->old_value, (long) (int32_t) p_record->new_value);
+        case TIME_MODEL_TRACE_TIMER:
+            return snprintf(p_buffer, size, "%10lu us %s tai %lu -> %lu",
+                            (unsigned long) p_record->timestamp, p_name,
+                            (unsigned long) p_record->old_value, (unsigned long) p_record->new_value);
+        default:
+            return snprintf(p_buffer, size, "%10lu us %s src 0x%04x %lu -> %lu detail %u",
+                            (unsigned long) p_record->timestamp, p_name, p_record->src,
+                            (unsigned long) p_record->old_value, (unsigned long) p_record->new_value,
+                            p_record->detail);
+    }
+}
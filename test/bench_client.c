@@ -0,0 +1,62 @@
+/**
+ * @file bench_client.c
+ * @brief Time Get requests per second through the request queue of the Time Client
+ *
+ * @details Each request is queued, sent, and ended by the Time Status of its destination received through the
+ * opcode handler table of the client, with max_in_flight requests kept in flight. This is the cost on the
+ * side of the client of polling a fleet of nodes, without the air time.
+ *
+ * Usage: bench_client [requests]
+ */
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_client.h"
+#include "time_model_messages.h"
+
+#define NODE_ADDRESS (0x0001)
+#define FIRST_DST (0x0100)
+#define DST_COUNT (0x1000)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+static time_client_t m_client = TIME_CLIENT_DEFAULT_SETTINGS;
+
+static uint32_t m_ended_count;
+static uint64_t m_tai_seconds_sum;
+
+static void request_cb(const time_client_t * p_self, uint16_t dst, uint32_t status, const time_status_params_t * p_in,
+                       void * p_context) {
+    CHECK(status == NRF_SUCCESS);
+    m_ended_count++;
+    m_tai_seconds_sum += p_in->tai_seconds - TAI_SECONDS_START;
+}
+
+int main(int argc, char ** argv) {
+    uint32_t count = test_count_arg(argc, argv, 1000000);
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint16_t length = test_time_msg_build(buffer, TAI_SECONDS_START + 1, 0, 10, true, 37 + 0xFF, 0x40);
+
+    mesh_stub_node_set(NODE_ADDRESS);
+    CHECK(time_client_init(&m_client, 0) == NRF_SUCCESS);
+    uint8_t in_flight = m_client.settings.max_in_flight;
+
+    uint64_t start = test_time_ns();
+    for (uint32_t i = 0; i < count + in_flight; i++) {
+        if (i < count) {
+            CHECK(time_client_time_get_queue(&m_client, FIRST_DST + i % DST_COUNT, request_cb, NULL) == NRF_SUCCESS);
+        }
+        /* The oldest request in flight is answered once the pipeline is full */
+        if (i >= in_flight) {
+            mesh_stub_rx(m_client.model_handle, TIME_OPCODE_STATUS, buffer, length,
+                         FIRST_DST + (i - in_flight) % DST_COUNT, 0);
+        }
+    }
+    uint64_t elapsed_ns = test_time_ns() - start;
+
+    CHECK(m_ended_count == count && m_tai_seconds_sum == count);
+    printf("%-16s %10u requests %10.1f ns/request %10.2f M requests/s (%u in flight)\n", "Queued Time Get", count,
+           (double) elapsed_ns / count, count / (elapsed_ns / 1e3), in_flight);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file bench_handlers.c
+ * @brief Cost of the Time Server, Time Setup Server and Time Client opcode handlers, in ns per message
+ *
+ * @details Each message goes through the opcode handler table of its model like in the mesh stack, and the
+ * reply each handler sends is checked once per run.
+ *
+ * Usage: bench_handlers [messages per opcode]
+ */
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_client.h"
+#include "time_model_messages.h"
+#include "time_model_setup_server.h"
+
+#define NODE_ADDRESS (0x0001)
+#define PEER_ADDRESS (0x0002)
+
+/** 2000-01-01 + about 22 years, in TAI seconds */
+#define TAI_SECONDS_START (700000000ULL)
+
+static time_setup_server_t m_server = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+static time_client_t m_client = TIME_CLIENT_DEFAULT_SETTINGS;
+
+static uint64_t m_client_tai_seconds;
+
+static void client_time_status_cb(const time_client_t * p_self, const access_message_rx_meta_t * p_meta,
+                                  const time_status_params_t * p_in) {
+    m_client_tai_seconds = p_in->tai_seconds;
+}
+
+static void report(const char * p_name, uint32_t count, uint64_t elapsed_ns) {
+    printf("%-16s %10u messages %10.1f ns/message\n", p_name, count, (double) elapsed_ns / count);
+}
+
+int main(int argc, char ** argv) {
+    uint32_t count = test_count_arg(argc, argv, 1000000);
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint16_t length;
+    uint64_t start;
+
+    mesh_stub_node_set(NODE_ADDRESS);
+    CHECK(time_setup_server_init(&m_server, 0) == NRF_SUCCESS);
+
+    access_model_handle_t server_handle = m_server.time_server.model_handle;
+    access_model_handle_t setup_handle = m_server.model_handle;
+
+    /* Time Set, answered with a Time Status */
+    start = test_time_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        length = test_time_msg_build(buffer, TAI_SECONDS_START + i, (uint8_t) i, 10, true, 37 + 0xFF, 0x40);
+        mesh_stub_rx(setup_handle, TIME_OPCODE_SET, buffer, length, PEER_ADDRESS, 0);
+    }
+    report("Time Set", count, test_time_ns() - start);
+
+    const mesh_stub_tx_t * p_tx = mesh_stub_last_tx();
+    CHECK(p_tx->opcode == TIME_OPCODE_STATUS && p_tx->dst == PEER_ADDRESS && p_tx->length == TIME_STATUS_MAXLEN);
+    CHECK(test_get_le(p_tx->data, 5) == TAI_SECONDS_START + count - 1);
+
+    /* Time Get, answered with a Time Status */
+    start = test_time_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        mesh_stub_rx(server_handle, TIME_OPCODE_GET, NULL, 0, PEER_ADDRESS + (i & 0xFF), 0);
+    }
+    report("Time Get", count, test_time_ns() - start);
+
+    CHECK(p_tx->opcode == TIME_OPCODE_STATUS && p_tx->length == TIME_STATUS_MAXLEN);
+    CHECK(test_get_le(p_tx->data, 5) == TAI_SECONDS_START + count - 1);
+
+    /* Time Status, synced to by a TIME CLIENT */
+    time_role_set_params_t role = {
+        .time_role = TIME_ROLE_CLIENT
+    };
+    CHECK(time_setup_server_state_set_time_role(&m_server, &role) == NRF_SUCCESS);
+
+    start = test_time_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        length = test_time_msg_build(buffer, TAI_SECONDS_START + 2 * i, (uint8_t) i, 10, true, 37 + 0xFF, 0x40);
+        mesh_stub_rx(server_handle, TIME_OPCODE_STATUS, buffer, length, PEER_ADDRESS, 0);
+    }
+    report("Time Status", count, test_time_ns() - start);
+
+    mesh_stub_rx(server_handle, TIME_OPCODE_GET, NULL, 0, PEER_ADDRESS, 0);
+    CHECK(test_get_le(p_tx->data, 5) == TAI_SECONDS_START + 2 * (count - 1));
+
+    /* Time Status, decoded by the Time Client */
+    time_client_callbacks_t client_callbacks = {
+        .time_status_cb = client_time_status_cb
+    };
+    CHECK(time_client_init(&m_client, 1) == NRF_SUCCESS);
+    CHECK(time_client_set_callbacks(&m_client, &client_callbacks) == NRF_SUCCESS);
+
+    start = test_time_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        length = test_time_msg_build(buffer, TAI_SECONDS_START + i, (uint8_t) i, 10, true, 37 + 0xFF, 0x40);
+        mesh_stub_rx(m_client.model_handle, TIME_OPCODE_STATUS, buffer, length, PEER_ADDRESS, 0);
+    }
+    report("Client Status", count, test_time_ns() - start);
+
+    CHECK(m_client_tai_seconds == TAI_SECONDS_START + count - 1);
+
+    return 0;
+}
@@ -0,0 +1,1079 @@
+/**
+ * @file mesh_sim.c
+ * @brief Discrete-event simulator of the propagation of time over a mesh of Time Servers
+ *
+ * @details Each node runs a Time Server / Time Setup Server pair through the SDK stand-in, ticked at 1 Hz by
+ * its own oscillator, with its own frequency error and phase. What the models publish is broadcast to the
+ * neighbours of the node in the topology, each copy delayed and possibly lost on its own, and relayed by the
+ * network layer of the nodes while its TTL allows, each node relaying a message once. The first node is the
+ * TIME AUTHORITY and publishes its time periodically, the others are TIME RELAY nodes, or TIME CLIENT nodes
+ * with --role client. With --clients, some nodes run a Time Client instead, which periodically sends a Time
+ * Get to the Time Servers around it.
+ *
+ * The time of a node is read with a Time Get through its handler right after each of its ticks, and compared
+ * to the time of the authority, which ticks without error. A node has converged once this offset is within
+ * the tolerance. The run reports when the last node converged, the offsets at the end of the run and the
+ * number of messages sent over the air, and a checksum of the final state of the nodes to compare runs.
+ *
+ * With --threads, the nodes are split in strips of the topology, each run by its own thread, which only
+ * synchronize with the others at the end of windows of simulated time as long as the shortest delay of a
+ * message: what a node sends during a window cannot be received before the next one, so each thread runs
+ * its window on its own and hands over the messages for the other strips at its end, through mailboxes
+ * which only its thread writes during the window and only the receiving thread reads after it.
+ *
+ * Events are ordered by their time, then by the node which scheduled them and its own count of the events it
+ * scheduled, and the random numbers are hashes of the seed and of these keys. Each node so handles the same
+ * events in the same order with any number of threads, and a run only depends on its options apart from
+ * --threads.
+ *
+ * Usage: mesh_sim [options], see usage()
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_client.h"
+#include "time_model_messages.h"
+#include "time_model_setup_server.h"
+
+/** Nodes have the unicast addresses from 1, and each has up to 2 models, in the 16-bit model handles */
+#define SIM_NODES_MAX (0x7FFF)
+
+#define SIM_THREADS_MAX (64)
+
+/** Group address all the models publish to */
+#define SIM_GROUP_ADDRESS (0xC000)
+
+/** TAI time of the authority at the start of the run */
+#define SIM_TAI_SECONDS_START (700000000ULL)
+
+/** Messages remembered per node by the network layer, not to relay them twice */
+#define SIM_NET_CACHE_SIZE (16)
+
+#define SIM_PAYLOAD_MAXLEN (12)
+
+#define US_PER_SEC (1000000ULL)
+
+typedef enum {
+    TOPOLOGY_LINE,
+    TOPOLOGY_GRID,
+    TOPOLOGY_RANDOM
+} topology_t;
+
+typedef struct {
+    uint32_t nodes;
+    topology_t topology;
+    /** Average number of neighbours of the random topology */
+    double degree;
+    uint64_t delay_us;
+    uint64_t jitter_us;
+    double loss;
+    double ppm;
+    uint64_t duration_us;
+    uint64_t publish_interval_us;
+    uint64_t tolerance_us;
+    time_role_t role;
+    uint8_t ttl;
+    uint32_t clients;
+    uint64_t get_interval_us;
+    uint64_t seed;
+    uint32_t threads;
+    /** Largest number of threads of the scaling benchmark, 0 for a single run */
+    uint32_t scaling;
+    /** Fail unless all the nodes converge */
+    bool check;
+} options_t;
+
+typedef enum {
+    EVENT_TICK,
+    EVENT_PUBLISH,
+    EVENT_GET,
+    EVENT_RX
+} event_type_t;
+
+typedef struct {
+    uint64_t time_us;
+    /** Node which scheduled the event, and its count of events scheduled, for a total order */
+    uint32_t src;
+    uint32_t seq;
+    /** Node the event runs on */
+    uint32_t node;
+    uint8_t type;
+    /** Received message: its first sender, its number there, its TTL, destination and payload. For a tick,
+        packet is the generation of the ticks of the node it belongs to */
+    uint8_t ttl;
+    uint16_t origin;
+    uint32_t packet;
+    uint16_t dst;
+    uint16_t opcode;
+    uint8_t length;
+    uint8_t data[SIM_PAYLOAD_MAXLEN];
+} event_t;
+
+typedef struct {
+    event_t * p_events;
+    uint32_t count;
+    uint32_t capacity;
+} event_list_t;
+
+typedef struct {
+    /** Time Client node, without a Time Server */
+    bool is_client;
+    time_setup_server_t server;
+    time_client_t client;
+    /** Neighbours, in m_neighbours from first_neighbour */
+    uint32_t first_neighbour;
+    uint32_t neighbour_count;
+    /** Position across the topology in [0, 1), which gives the strip of the node */
+    double strip;
+    uint32_t partition;
+    /** Oscillator: period of the 1 Hz tick in us, time of the first tick, ticks so far, and the number of times
+        the ticks were restarted */
+    double tick_period_us;
+    uint64_t tick_phase_us;
+    uint64_t tick_count;
+    uint32_t tick_generation;
+    uint32_t event_seq;
+    uint32_t packet_seq;
+    uint64_t net_cache[SIM_NET_CACHE_SIZE];
+    uint8_t net_cache_next;
+    /** Offset to the authority at the last tick, and when it first was within the tolerance */
+    int64_t offset_us;
+    uint64_t converged_us;
+    /** Time Gets sent and unanswered, Time Status received, and those within the tolerance with their offsets */
+    uint32_t get_count;
+    uint32_t timeout_count;
+    uint32_t reply_count;
+    uint32_t reply_good_count;
+    uint64_t reply_offset_sum_us;
+} node_t;
+
+typedef struct {
+    uint32_t index;
+    pthread_t thread;
+    /** Events of the nodes of the partition, as a binary heap */
+    event_list_t heap;
+    /** Events for the other partitions, handed over at the end of the window */
+    event_list_t * p_outboxes;
+    /** Earliest event once the mailboxes are emptied */
+    uint64_t next_us;
+    uint64_t transmissions;
+    uint64_t relayed;
+    uint64_t lost;
+    uint64_t event_count;
+} partition_t;
+
+typedef struct {
+    double wall_s;
+    uint64_t checksum;
+} result_t;
+
+static options_t m_options = {
+    .nodes = 1000,
+    .topology = TOPOLOGY_GRID,
+    .degree = 8,
+    .delay_us = 10000,
+    .jitter_us = 20000,
+    .loss = 0.0,
+    .ppm = 40,
+    .duration_us = 60 * US_PER_SEC,
+    .publish_interval_us = 10 * US_PER_SEC,
+    .tolerance_us = US_PER_SEC,
+    .role = TIME_ROLE_RELAY,
+    .ttl = 2,
+    .clients = 0,
+    .get_interval_us = 5 * US_PER_SEC,
+    .seed = 1,
+    .threads = 1,
+    .scaling = 0,
+    .check = false
+};
+
+static node_t * m_nodes;
+static uint32_t * m_neighbours;
+static uint32_t m_link_count;
+static partition_t * m_partitions;
+static uint32_t m_partition_count;
+static pthread_barrier_t m_barrier;
+
+/** Partition of the calling thread, and the time of the event it runs */
+static _Thread_local partition_t * mp_partition;
+static _Thread_local uint64_t m_now_us;
+/** Set while reading the time of a node, whose Time Get reply is not sent over the air */
+static _Thread_local bool m_reading;
+
+/*********************************************************************
+    RANDOM NUMBERS AND EVENT QUEUE
+**********************************************************************/
+
+typedef enum {
+    DRAW_POSITION,
+    DRAW_OSCILLATOR,
+    DRAW_LOSS,
+    DRAW_DELAY,
+    DRAW_GET
+} draw_t;
+
+/** splitmix64 finalizer, as a hash of the keys of a random draw */
+static uint64_t hash64(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/** Uniform draw in [0, 1) from the seed, what it is for and two keys */
+static double random_draw(draw_t draw, uint64_t key1, uint64_t key2) {
+    uint64_t value = hash64(m_options.seed ^ hash64(draw ^ hash64(key1 ^ hash64(key2))));
+    return (double) (value >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static void list_append(event_list_t * p_list, const event_t * p_event) {
+    if (p_list->count == p_list->capacity) {
+        p_list->capacity = p_list->capacity == 0 ? 1024 : p_list->capacity * 2;
+        p_list->p_events = realloc(p_list->p_events, p_list->capacity * sizeof(event_t));
+        CHECK(p_list->p_events != NULL);
+    }
+    p_list->p_events[p_list->count++] = *p_event;
+}
+
+static inline bool event_before(const event_t * p_a, const event_t * p_b) {
+    if (p_a->time_us != p_b->time_us) {
+        return p_a->time_us < p_b->time_us;
+    }
+    if (p_a->src != p_b->src) {
+        return p_a->src < p_b->src;
+    }
+    return p_a->seq < p_b->seq;
+}
+
+static void heap_push(event_list_t * p_heap, const event_t * p_event) {
+    list_append(p_heap, p_event);
+
+    uint32_t i = p_heap->count - 1;
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (!event_before(p_event, &p_heap->p_events[parent])) {
+            break;
+        }
+        p_heap->p_events[i] = p_heap->p_events[parent];
+        i = parent;
+    }
+    p_heap->p_events[i] = *p_event;
+}
+
+static void heap_pop(event_list_t * p_heap, event_t * p_event) {
+    *p_event = p_heap->p_events[0];
+    event_t last = p_heap->p_events[--p_heap->count];
+
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= p_heap->count) {
+            break;
+        }
+        if (child + 1 < p_heap->count && event_before(&p_heap->p_events[child + 1], &p_heap->p_events[child])) {
+            child++;
+        }
+        if (!event_before(&p_heap->p_events[child], &last)) {
+            break;
+        }
+        p_heap->p_events[i] = p_heap->p_events[child];
+        i = child;
+    }
+    p_heap->p_events[i] = last;
+}
+
+/** Schedules an event scheduled by p_src, on the node of the event, which may be in another partition */
+static void event_schedule(node_t * p_src, event_t * p_event) {
+    p_event->src = (uint32_t) (p_src - m_nodes);
+    p_event->seq = p_src->event_seq++;
+
+    uint32_t partition = m_nodes[p_event->node].partition;
+    if (partition == mp_partition->index) {
+        heap_push(&mp_partition->heap, p_event);
+    } else {
+        list_append(&mp_partition->p_outboxes[partition], p_event);
+    }
+}
+
+/*********************************************************************
+    TOPOLOGY
+**********************************************************************/
+
+static void topology_build(void) {
+    uint32_t n = m_options.nodes;
+    uint32_t capacity = 0;
+    uint32_t count = 0;
+
+    /* Neighbour pairs, both ways, collected per node in order */
+    uint32_t (*p_pairs)[2] = NULL;
+#define PAIR_ADD(a, b)                                                           \
+    do {                                                                         \
+        if (count + 2 > capacity) {                                              \
+            capacity = capacity == 0 ? 4 * n : capacity * 2;                     \
+            p_pairs = realloc(p_pairs, capacity * sizeof(*p_pairs));             \
+            CHECK(p_pairs != NULL);                                              \
+        }                                                                        \
+        p_pairs[count][0] = (a);                                                 \
+        p_pairs[count++][1] = (b);                                               \
+        p_pairs[count][0] = (b);                                                 \
+        p_pairs[count++][1] = (a);                                               \
+    } while (0)
+
+    if (m_options.topology == TOPOLOGY_LINE) {
+        for (uint32_t i = 0; i < n; i++) {
+            m_nodes[i].strip = (double) i / n;
+            if (i + 1 < n) {
+                PAIR_ADD(i, i + 1);
+            }
+        }
+    } else if (m_options.topology == TOPOLOGY_GRID) {
+        uint32_t side = (uint32_t) ceil(sqrt((double) n));
+        uint32_t rows = (n + side - 1) / side;
+        for (uint32_t i = 0; i < n; i++) {
+            m_nodes[i].strip = (double) (i / side) / rows;
+            if ((i % side) + 1 < side && i + 1 < n) {
+                PAIR_ADD(i, i + 1);
+            }
+            if (i + side < n) {
+                PAIR_ADD(i, i + side);
+            }
+        }
+    } else {
+        /* Random geometric graph in the unit square, with cells of the radio range to only compare close nodes */
+        double range = sqrt(m_options.degree / (M_PI * n));
+        uint32_t cells = (uint32_t) (1.0 / range);
+        if (cells == 0) {
+            cells = 1;
+        }
+        double * p_x = malloc(n * sizeof(double));
+        double * p_y = malloc(n * sizeof(double));
+        uint32_t * p_cell_first = calloc(cells * cells + 1, sizeof(uint32_t));
+        uint32_t * p_fill = malloc(cells * cells * sizeof(uint32_t));
+        uint32_t * p_by_cell = malloc(n * sizeof(uint32_t));
+        CHECK(p_x != NULL && p_y != NULL && p_cell_first != NULL && p_fill != NULL && p_by_cell != NULL);
+
+        for (uint32_t i = 0; i < n; i++) {
+            p_x[i] = random_draw(DRAW_POSITION, i, 0);
+            p_y[i] = random_draw(DRAW_POSITION, i, 1);
+            m_nodes[i].strip = p_y[i];
+            uint32_t cell = (uint32_t) (p_y[i] * cells) * cells + (uint32_t) (p_x[i] * cells);
+            p_cell_first[cell + 1]++;
+        }
+        for (uint32_t cell = 0; cell < cells * cells; cell++) {
+            p_cell_first[cell + 1] += p_cell_first[cell];
+        }
+        memcpy(p_fill, p_cell_first, cells * cells * sizeof(uint32_t));
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t cell = (uint32_t) (p_y[i] * cells) * cells + (uint32_t) (p_x[i] * cells);
+            p_by_cell[p_fill[cell]++] = i;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t cx = (int32_t) (p_x[i] * cells);
+            int32_t cy = (int32_t) (p_y[i] * cells);
+            for (int32_t y = cy - 1; y <= cy + 1; y++) {
+                for (int32_t x = cx - 1; x <= cx + 1; x++) {
+                    if (x < 0 || y < 0 || x >= (int32_t) cells || y >= (int32_t) cells) {
+                        continue;
+                    }
+                    uint32_t cell = (uint32_t) y * cells + (uint32_t) x;
+                    for (uint32_t k = p_cell_first[cell]; k < p_cell_first[cell + 1]; k++) {
+                        uint32_t j = p_by_cell[k];
+                        double dx = p_x[i] - p_x[j];
+                        double dy = p_y[i] - p_y[j];
+                        if (j > i && dx * dx + dy * dy <= range * range) {
+                            PAIR_ADD(i, j);
+                        }
+                    }
+                }
+            }
+        }
+        free(p_x);
+        free(p_y);
+        free(p_cell_first);
+        free(p_fill);
+        free(p_by_cell);
+    }
+#undef PAIR_ADD
+
+    /* Compressed adjacency lists, with the neighbours of each node in increasing order */
+    m_link_count = count;
+    m_neighbours = malloc((count + 1) * sizeof(uint32_t));
+    CHECK(m_neighbours != NULL);
+    for (uint32_t k = 0; k < count; k++) {
+        m_nodes[p_pairs[k][0]].neighbour_count++;
+    }
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        m_nodes[i].first_neighbour = first;
+        first += m_nodes[i].neighbour_count;
+        m_nodes[i].neighbour_count = 0;
+    }
+    for (uint32_t k = 0; k < count; k++) {
+        node_t * p_node = &m_nodes[p_pairs[k][0]];
+        m_neighbours[p_node->first_neighbour + p_node->neighbour_count++] = p_pairs[k][1];
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t * p_list = &m_neighbours[m_nodes[i].first_neighbour];
+        for (uint32_t a = 1; a < m_nodes[i].neighbour_count; a++) {
+            uint32_t value = p_list[a];
+            uint32_t b = a;
+            while (b > 0 && p_list[b - 1] > value) {
+                p_list[b] = p_list[b - 1];
+                b--;
+            }
+            p_list[b] = value;
+        }
+    }
+    free(p_pairs);
+}
+
+/*********************************************************************
+    RADIO AND NETWORK LAYER
+**********************************************************************/
+
+/** Sends a message to all the neighbours of a node, each copy delayed and possibly lost on its own */
+static void broadcast(node_t * p_node, const event_t * p_message) {
+    uint64_t index = (uint64_t) (p_node - m_nodes);
+    uint64_t key = ((uint64_t) p_message->origin << 32) | p_message->packet;
+
+    mp_partition->transmissions++;
+    for (uint32_t k = 0; k < p_node->neighbour_count; k++) {
+        uint32_t neighbour = m_neighbours[p_node->first_neighbour + k];
+        uint64_t link = (index << 32) | neighbour;
+
+        if (m_options.loss > 0 && random_draw(DRAW_LOSS, link, key) < m_options.loss) {
+            mp_partition->lost++;
+            continue;
+        }
+
+        event_t event = *p_message;
+        event.type = EVENT_RX;
+        event.node = neighbour;
+        event.time_us = m_now_us + m_options.delay_us +
+                        (uint64_t) (random_draw(DRAW_DELAY, link, key) * (double) m_options.jitter_us);
+        event_schedule(p_node, &event);
+    }
+}
+
+static bool net_cache_add(node_t * p_node, uint16_t origin, uint32_t packet) {
+    uint64_t key = ((uint64_t) origin << 32) | packet;
+    for (uint8_t i = 0; i < SIM_NET_CACHE_SIZE; i++) {
+        if (p_node->net_cache[i] == key) {
+            return false;
+        }
+    }
+    p_node->net_cache[p_node->net_cache_next] = key;
+    p_node->net_cache_next = (p_node->net_cache_next + 1) % SIM_NET_CACHE_SIZE;
+    return true;
+}
+
+/** Everything the models send goes over the air, apart from the replies to the time readings of the simulator */
+static void sim_tx(access_model_handle_t handle, uint16_t src, uint16_t dst, uint8_t ttl,
+                   const access_message_tx_t * p_message) {
+    if (m_reading || p_message->length > SIM_PAYLOAD_MAXLEN) {
+        return;
+    }
+
+    node_t * p_node = &m_nodes[src - 1];
+    event_t event = {
+        .ttl = ttl,
+        .origin = src,
+        .packet = p_node->packet_seq++,
+        .dst = dst,
+        .opcode = p_message->opcode.opcode,
+        .length = (uint8_t) p_message->length
+    };
+    if (p_message->length > 0) {
+        memcpy(event.data, p_message->p_buffer, p_message->length);
+    }
+    net_cache_add(p_node, event.origin, event.packet);
+    broadcast(p_node, &event);
+}
+
+/*********************************************************************
+    NODES
+**********************************************************************/
+
+static inline uint16_t node_address(const node_t * p_node) {
+    return (uint16_t) (p_node - m_nodes + 1);
+}
+
+static inline int64_t offset_to_authority(uint64_t tai_seconds, uint8_t subsecond) {
+    uint64_t time_us = tai_seconds * US_PER_SEC + subsecond * US_PER_SEC / 256;
+    return (int64_t) (time_us - (SIM_TAI_SECONDS_START * US_PER_SEC + m_now_us));
+}
+
+/** Offset of the time of a node to the authority, read with a Time Get through its handler */
+static int64_t node_offset_read(node_t * p_node) {
+    const mesh_stub_tx_t * p_tx = mesh_stub_last_tx();
+
+    m_reading = true;
+    mesh_stub_rx(p_node->server.time_server.model_handle, TIME_OPCODE_GET, NULL, 0, node_address(p_node), 0);
+    m_reading = false;
+
+    return offset_to_authority(test_get_le(p_tx->data, 5), p_tx->length == TIME_STATUS_MAXLEN ? p_tx->data[5] : 0);
+}
+
+static uint64_t tick_time(const node_t * p_node, uint64_t tick) {
+    return p_node->tick_phase_us + (uint64_t) llround((double) tick * p_node->tick_period_us);
+}
+
+static void node_tick(node_t * p_node) {
+    time_state_update_time_delta(&p_node->server.time_server, 1, 0);
+
+    p_node->offset_us = node_offset_read(p_node);
+    if ((uint64_t) llabs(p_node->offset_us) <= m_options.tolerance_us) {
+        if (p_node->converged_us == UINT64_MAX) {
+            p_node->converged_us = m_now_us;
+        }
+    } else {
+        p_node->converged_us = UINT64_MAX;
+    }
+
+    event_t event = {
+        .type = EVENT_TICK,
+        .node = (uint32_t) (p_node - m_nodes),
+        .packet = p_node->tick_generation,
+        .time_us = tick_time(p_node, ++p_node->tick_count)
+    };
+    event_schedule(p_node, &event);
+}
+
+/**
+ * The models restart their repeated app timer when the time is set, so the next tick comes a period after. The
+ * tick already scheduled is left in the queue, and ignored for its older generation.
+ */
+static void node_tick_restart(node_t * p_node) {
+    p_node->tick_generation++;
+    p_node->tick_phase_us = m_now_us;
+    p_node->tick_count = 0;
+
+    event_t event = {
+        .type = EVENT_TICK,
+        .node = (uint32_t) (p_node - m_nodes),
+        .packet = p_node->tick_generation,
+        .time_us = tick_time(p_node, ++p_node->tick_count)
+    };
+    event_schedule(p_node, &event);
+}
+
+static uint64_t node_time_state_get(const node_t * p_node) {
+    const time_server_state_t * p_state = &p_node->server.time_server.server_state;
+    return ((uint64_t) p_state->tai_seconds << 24) | ((uint32_t) p_state->subsecond << 16) | p_state->subsecond_fraction;
+}
+
+static void node_get(node_t * p_node, event_t * p_event) {
+    /* A Time Get nobody answered is given up before the next one */
+    if (!access_reliable_model_is_free(p_node->client.model_handle)) {
+        (void) access_model_reliable_cancel(p_node->client.model_handle);
+        p_node->timeout_count++;
+    }
+    if (time_client_time_get(&p_node->client) == NRF_SUCCESS) {
+        p_node->get_count++;
+    }
+
+    p_event->time_us += m_options.get_interval_us;
+    event_schedule(p_node, p_event);
+}
+
+static void client_time_status_cb(const time_client_t * p_self, const access_message_rx_meta_t * p_meta,
+                                  const time_status_params_t * p_in) {
+    node_t * p_node = (node_t *) ((const uint8_t *) p_self - offsetof(node_t, client));
+
+    int64_t offset_us = offset_to_authority(p_in->tai_seconds, p_in->subsecond);
+
+    p_node->reply_count++;
+    if ((uint64_t) llabs(offset_us) <= m_options.tolerance_us) {
+        p_node->reply_good_count++;
+        p_node->reply_offset_sum_us += (uint64_t) llabs(offset_us);
+    }
+}
+
+static void node_rx(node_t * p_node, const event_t * p_event) {
+    if (!net_cache_add(p_node, p_event->origin, p_event->packet)) {
+        return;
+    }
+
+    if (p_event->dst == SIM_GROUP_ADDRESS || p_event->dst == node_address(p_node)) {
+        if (p_node->is_client) {
+            mesh_stub_rx(p_node->client.model_handle, p_event->opcode, p_event->data, p_event->length,
+                         p_event->origin, p_event->ttl);
+        } else {
+            uint64_t time_state = node_time_state_get(p_node);
+            mesh_stub_rx(p_node->server.time_server.model_handle, p_event->opcode, p_event->data, p_event->length,
+                         p_event->origin, p_event->ttl);
+            mesh_stub_rx(p_node->server.model_handle, p_event->opcode, p_event->data, p_event->length,
+                         p_event->origin, p_event->ttl);
+            if (node_time_state_get(p_node) != time_state) {
+                node_tick_restart(p_node);
+            }
+        }
+    }
+
+    /* Network layer relaying, with the TTL decremented */
+    if (p_event->ttl >= 2) {
+        event_t relay = *p_event;
+        relay.ttl--;
+        mp_partition->relayed++;
+        broadcast(p_node, &relay);
+    }
+}
+
+static void nodes_init(void) {
+    uint32_t n = m_options.nodes;
+
+    m_nodes = calloc(n, sizeof(node_t));
+    CHECK(m_nodes != NULL);
+
+    /* Time Client nodes spread evenly over the others */
+    for (uint32_t k = 0; k < m_options.clients; k++) {
+        m_nodes[1 + (uint64_t) k * (n - 1) / m_options.clients].is_client = true;
+    }
+
+    const time_client_callbacks_t client_callbacks = {
+        .time_status_cb = client_time_status_cb
+    };
+
+    for (uint32_t i = 0; i < n; i++) {
+        node_t * p_node = &m_nodes[i];
+
+        mesh_stub_node_set(node_address(p_node));
+        p_node->converged_us = UINT64_MAX;
+
+        if (p_node->is_client) {
+            time_client_t client = TIME_CLIENT_DEFAULT_SETTINGS;
+            p_node->client = client;
+            CHECK(time_client_init(&p_node->client, 0) == NRF_SUCCESS);
+            CHECK(time_client_set_callbacks(&p_node->client, &client_callbacks) == NRF_SUCCESS);
+            mesh_stub_publish_address_set(p_node->client.model_handle, SIM_GROUP_ADDRESS);
+            CHECK(access_model_publish_ttl_set(p_node->client.model_handle, m_options.ttl) == NRF_SUCCESS);
+            continue;
+        }
+
+        time_setup_server_t server = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+        time_role_set_params_t role = {
+            .time_role = i == 0 ? TIME_ROLE_AUTHORITY : m_options.role
+        };
+
+        p_node->server = server;
+        CHECK(time_setup_server_init(&p_node->server, 0) == NRF_SUCCESS);
+        mesh_stub_publish_address_set(p_node->server.time_server.model_handle, SIM_GROUP_ADDRESS);
+        mesh_stub_publish_address_set(p_node->server.model_handle, SIM_GROUP_ADDRESS);
+        CHECK(access_model_publish_ttl_set(p_node->server.time_server.model_handle, m_options.ttl) == NRF_SUCCESS);
+        CHECK(access_model_publish_ttl_set(p_node->server.model_handle, m_options.ttl) == NRF_SUCCESS);
+        CHECK(time_setup_server_state_set_time_role(&p_node->server, &role) == NRF_SUCCESS);
+
+        double ppm = i == 0 ? 0 : (2 * random_draw(DRAW_OSCILLATOR, i, 0) - 1) * m_options.ppm;
+        p_node->tick_period_us = (double) US_PER_SEC * (1 + ppm * 1e-6);
+        p_node->tick_phase_us = i == 0 ? US_PER_SEC : (uint64_t) (random_draw(DRAW_OSCILLATOR, i, 1) * US_PER_SEC);
+    }
+
+    /* The authority has the time from the start, and publishes it from its first tick */
+    time_set_params_t time = {
+        .tai_seconds = SIM_TAI_SECONDS_START,
+        .subsecond = 0,
+        .uncertainty = 0,
+        .time_authority = true,
+        .tai_utc_delta = 37,
+        .time_zone_offset = 0
+    };
+    mesh_stub_node_set(1);
+    CHECK(time_server_state_set_time(&m_nodes[0].server.time_server, &time) == NRF_SUCCESS);
+}
+
+/*********************************************************************
+    PARTITIONS
+**********************************************************************/
+
+static void partitions_init(uint32_t count) {
+    m_partition_count = count;
+    m_partitions = calloc(count, sizeof(partition_t));
+    CHECK(m_partitions != NULL);
+
+    for (uint32_t p = 0; p < count; p++) {
+        m_partitions[p].index = p;
+        m_partitions[p].p_outboxes = calloc(count, sizeof(event_list_t));
+        CHECK(m_partitions[p].p_outboxes != NULL);
+    }
+    for (uint32_t i = 0; i < m_options.nodes; i++) {
+        uint32_t partition = (uint32_t) (m_nodes[i].strip * count);
+        m_nodes[i].partition = partition < count ? partition : count - 1;
+    }
+
+    /* The first events of each node, scheduled by the node itself */
+    for (uint32_t i = 0; i < m_options.nodes; i++) {
+        node_t * p_node = &m_nodes[i];
+        event_t event = {
+            .node = i
+        };
+
+        mp_partition = &m_partitions[p_node->partition];
+        if (p_node->is_client) {
+            event.type = EVENT_GET;
+            event.time_us = US_PER_SEC + (uint64_t) (random_draw(DRAW_GET, i, 0) * m_options.get_interval_us);
+        } else {
+            event.type = EVENT_TICK;
+            event.time_us = tick_time(p_node, 0);
+        }
+        event_schedule(p_node, &event);
+
+        /* Just after the ticks of the authority, as its time state only moves on when it ticks */
+        if (i == 0) {
+            event.type = EVENT_PUBLISH;
+            event.time_us = US_PER_SEC + 1;
+            event_schedule(p_node, &event);
+        }
+    }
+    mp_partition = NULL;
+}
+
+static void partitions_free(void) {
+    for (uint32_t p = 0; p < m_partition_count; p++) {
+        for (uint32_t q = 0; q < m_partition_count; q++) {
+            free(m_partitions[p].p_outboxes[q].p_events);
+        }
+        free(m_partitions[p].p_outboxes);
+        free(m_partitions[p].heap.p_events);
+    }
+    free(m_partitions);
+    m_partitions = NULL;
+}
+
+static void event_run(event_t * p_event) {
+    node_t * p_node = &m_nodes[p_event->node];
+
+    m_now_us = p_event->time_us;
+    mesh_stub_time_set(m_now_us);
+    mesh_stub_node_set(node_address(p_node));
+
+    switch (p_event->type) {
+        case EVENT_TICK:
+            if (p_event->packet == p_node->tick_generation) {
+                node_tick(p_node);
+            }
+            break;
+        case EVENT_PUBLISH:
+            mesh_stub_publish_timeout(p_node->server.time_server.model_handle);
+            p_event->time_us += m_options.publish_interval_us;
+            event_schedule(p_node, p_event);
+            break;
+        case EVENT_GET:
+            node_get(p_node, p_event);
+            break;
+        case EVENT_RX:
+            node_rx(p_node, p_event);
+            break;
+    }
+}
+
+/** Moves the events other partitions sent to this one to its heap, and finds its earliest event */
+static void mailboxes_empty(partition_t * p_partition) {
+    for (uint32_t p = 0; p < m_partition_count; p++) {
+        event_list_t * p_mailbox = &m_partitions[p].p_outboxes[p_partition->index];
+        for (uint32_t k = 0; k < p_mailbox->count; k++) {
+            heap_push(&p_partition->heap, &p_mailbox->p_events[k]);
+        }
+        p_mailbox->count = 0;
+    }
+    p_partition->next_us = p_partition->heap.count > 0 ? p_partition->heap.p_events[0].time_us : UINT64_MAX;
+}
+
+static void * partition_run(void * p_context) {
+    partition_t * p_partition = (partition_t *) p_context;
+    /* No message is received earlier than the shortest delay after it was sent */
+    uint64_t window_us = m_options.delay_us > 0 ? m_options.delay_us : 1;
+
+    mp_partition = p_partition;
+    mailboxes_empty(p_partition);
+    pthread_barrier_wait(&m_barrier);
+
+    for (;;) {
+        uint64_t start_us = UINT64_MAX;
+        for (uint32_t p = 0; p < m_partition_count; p++) {
+            if (m_partitions[p].next_us < start_us) {
+                start_us = m_partitions[p].next_us;
+            }
+        }
+        if (start_us > m_options.duration_us) {
+            break;
+        }
+
+        uint64_t end_us = start_us + window_us;
+        while (p_partition->heap.count > 0 && p_partition->heap.p_events[0].time_us < end_us &&
+               p_partition->heap.p_events[0].time_us <= m_options.duration_us) {
+            event_t event;
+            heap_pop(&p_partition->heap, &event);
+            p_partition->event_count++;
+            event_run(&event);
+        }
+
+        /* The outboxes are written until all the partitions are done with the window, then read */
+        pthread_barrier_wait(&m_barrier);
+        mailboxes_empty(p_partition);
+        pthread_barrier_wait(&m_barrier);
+    }
+    return NULL;
+}
+
+/*********************************************************************
+    RUN AND REPORT
+**********************************************************************/
+
+static int compare_u64(const void * p_a, const void * p_b) {
+    uint64_t a = *(const uint64_t *) p_a;
+    uint64_t b = *(const uint64_t *) p_b;
+    return (a > b) - (a < b);
+}
+
+static bool report(double wall_s, bool print, uint64_t * p_checksum) {
+    uint32_t n = m_options.nodes;
+    uint32_t servers = 0;
+    uint32_t converged = 0;
+    uint64_t convergence_us = 0;
+    uint64_t * p_offsets = malloc(n * sizeof(uint64_t));
+    double mean_ms = 0;
+    uint64_t gets = 0;
+    uint64_t timeouts = 0;
+    uint64_t replies = 0;
+    uint64_t good_replies = 0;
+    uint64_t reply_offset_sum_us = 0;
+    uint64_t checksum = 0xCBF29CE484222325ULL;
+    partition_t total = {0};
+
+    CHECK(p_offsets != NULL);
+    for (uint32_t i = 0; i < n; i++) {
+        node_t * p_node = &m_nodes[i];
+        if (p_node->is_client) {
+            gets += p_node->get_count;
+            timeouts += p_node->timeout_count;
+            replies += p_node->reply_count;
+            good_replies += p_node->reply_good_count;
+            reply_offset_sum_us += p_node->reply_offset_sum_us;
+            checksum = (checksum ^ p_node->reply_count) * 0x100000001B3ULL;
+            checksum = (checksum ^ p_node->reply_good_count) * 0x100000001B3ULL;
+            checksum = (checksum ^ p_node->reply_offset_sum_us) * 0x100000001B3ULL;
+            continue;
+        }
+
+        servers++;
+        if (p_node->converged_us != UINT64_MAX) {
+            if (p_node->converged_us > convergence_us) {
+                convergence_us = p_node->converged_us;
+            }
+            p_offsets[converged++] = (uint64_t) llabs(p_node->offset_us);
+            mean_ms += (double) p_node->offset_us / 1000;
+        }
+        checksum = (checksum ^ (uint64_t) p_node->offset_us) * 0x100000001B3ULL;
+        checksum = (checksum ^ p_node->converged_us) * 0x100000001B3ULL;
+    }
+    for (uint32_t p = 0; p < m_partition_count; p++) {
+        total.transmissions += m_partitions[p].transmissions;
+        total.relayed += m_partitions[p].relayed;
+        total.lost += m_partitions[p].lost;
+        total.event_count += m_partitions[p].event_count;
+    }
+    checksum = (checksum ^ total.transmissions) * 0x100000001B3ULL;
+    checksum = (checksum ^ total.event_count) * 0x100000001B3ULL;
+    *p_checksum = checksum;
+
+    if (print) {
+        static const char * const topologies[] = {"line", "grid", "random"};
+        printf("nodes %u, %s topology, %u links, %s nodes, %u clients, %u threads\n", n,
+               topologies[m_options.topology], m_link_count / 2,
+               m_options.role == TIME_ROLE_CLIENT ? "client" : "relay", m_options.clients, m_partition_count);
+        if (converged == servers) {
+            printf("converged: all servers within %.0f ms at %.3f s\n", m_options.tolerance_us / 1000.0,
+                   convergence_us / 1e6);
+        } else {
+            printf("converged: %u of %u servers within %.0f ms\n", converged, servers,
+                   m_options.tolerance_us / 1000.0);
+        }
+        if (converged > 0) {
+            qsort(p_offsets, converged, sizeof(uint64_t), compare_u64);
+            printf("offset of the converged servers at the end: mean %.1f ms, |offset| median %.1f ms, "
+                   "p99 %.1f ms, max %.1f ms\n", mean_ms / converged, p_offsets[converged / 2] / 1000.0,
+                   p_offsets[(uint32_t) (converged * 0.99)] / 1000.0, p_offsets[converged - 1] / 1000.0);
+        }
+        if (m_options.clients > 0) {
+            printf("clients: %" PRIu64 " Time Gets, %" PRIu64 " unanswered, %" PRIu64 " Time Status received, "
+                   "%" PRIu64 " within %.0f ms with |offset| mean %.1f ms\n", gets, timeouts, replies, good_replies,
+                   m_options.tolerance_us / 1000.0, good_replies > 0 ? reply_offset_sum_us / 1000.0 / good_replies : 0.0);
+        }
+        printf("transmissions: %" PRIu64 " (%" PRIu64 " network relays, %" PRIu64 " copies lost)\n",
+               total.transmissions, total.relayed, total.lost);
+        printf("events: %" PRIu64 " in %.3f s (%.2f M events/s)\n", total.event_count, wall_s,
+               total.event_count / wall_s / 1e6);
+        printf("checksum: %016" PRIx64 "\n", checksum);
+    }
+
+    free(p_offsets);
+    return converged == servers;
+}
+
+/** Runs the simulation from the start with a number of threads */
+static bool simulate(uint32_t threads, bool print, result_t * p_result) {
+    mesh_stub_reset();
+    nodes_init();
+    topology_build();
+    partitions_init(threads);
+
+    CHECK(pthread_barrier_init(&m_barrier, NULL, threads) == 0);
+    mesh_stub_tx_cb_set(sim_tx);
+
+    uint64_t start = test_time_ns();
+    for (uint32_t p = 1; p < threads; p++) {
+        CHECK(pthread_create(&m_partitions[p].thread, NULL, partition_run, &m_partitions[p]) == 0);
+    }
+    partition_run(&m_partitions[0]);
+    for (uint32_t p = 1; p < threads; p++) {
+        CHECK(pthread_join(m_partitions[p].thread, NULL) == 0);
+    }
+    p_result->wall_s = (test_time_ns() - start) / 1e9;
+
+    mesh_stub_tx_cb_set(NULL);
+    pthread_barrier_destroy(&m_barrier);
+
+    bool converged = report(p_result->wall_s, print, &p_result->checksum);
+
+    partitions_free();
+    free(m_neighbours);
+    free(m_nodes);
+    return converged;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: mesh_sim [options]\n"
+            "  --nodes N              number of nodes, up to %u (1000)\n"
+            "  --topology T           line, grid or random (grid)\n"
+            "  --degree D             average neighbours of the random topology (8)\n"
+            "  --delay-ms MS          delay of each copy of a message (10)\n"
+            "  --jitter-ms MS         added uniform delay of each copy (20)\n"
+            "  --loss P               probability to lose each copy (0)\n"
+            "  --ppm PPM              largest frequency error of the oscillators (40)\n"
+            "  --duration S           simulated time in seconds (60)\n"
+            "  --publish-interval S   period of the authority publications (10)\n"
+            "  --tolerance-ms MS      offset under which a node has converged (1000)\n"
+            "  --role R               role of the other servers, relay or client (relay)\n"
+            "  --ttl TTL              TTL of the messages of the models (2)\n"
+            "  --clients N            number of Time Client nodes (0)\n"
+            "  --get-interval S       period of the Time Gets of the clients (5)\n"
+            "  --seed N               seed of the random draws (1)\n"
+            "  --threads N            number of threads, up to %u (1)\n"
+            "  --scaling N            run with 1, 2, 4... up to N threads and compare the runs\n"
+            "  --check                fail unless all the servers converge\n",
+            SIM_NODES_MAX, SIM_THREADS_MAX);
+    exit(2);
+}
+
+static void options_parse(int argc, char ** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char * p_option = argv[i];
+        const char * p_value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(p_option, "--check") == 0) {
+            m_options.check = true;
+            continue;
+        }
+        if (p_value == NULL) {
+            usage();
+        }
+        i++;
+
+        if (strcmp(p_option, "--nodes") == 0) {
+            m_options.nodes = (uint32_t) strtoul(p_value, NULL, 0);
+        } else if (strcmp(p_option, "--topology") == 0) {
+            if (strcmp(p_value, "line") == 0) {
+                m_options.topology = TOPOLOGY_LINE;
+            } else if (strcmp(p_value, "grid") == 0) {
+                m_options.topology = TOPOLOGY_GRID;
+            } else if (strcmp(p_value, "random") == 0) {
+                m_options.topology = TOPOLOGY_RANDOM;
+            } else {
+                usage();
+            }
+        } else if (strcmp(p_option, "--degree") == 0) {
+            m_options.degree = strtod(p_value, NULL);
+        } else if (strcmp(p_option, "--delay-ms") == 0) {
+            m_options.delay_us = (uint64_t) (strtod(p_value, NULL) * 1000);
+        } else if (strcmp(p_option, "--jitter-ms") == 0) {
+            m_options.jitter_us = (uint64_t) (strtod(p_value, NULL) * 1000);
+        } else if (strcmp(p_option, "--loss") == 0) {
+            m_options.loss = strtod(p_value, NULL);
+        } else if (strcmp(p_option, "--ppm") == 0) {
+            m_options.ppm = strtod(p_value, NULL);
+        } else if (strcmp(p_option, "--duration") == 0) {
+            m_options.duration_us = (uint64_t) (strtod(p_value, NULL) * US_PER_SEC);
+        } else if (strcmp(p_option, "--publish-interval") == 0) {
+            m_options.publish_interval_us = (uint64_t) (strtod(p_value, NULL) * US_PER_SEC);
+        } else if (strcmp(p_option, "--tolerance-ms") == 0) {
+            m_options.tolerance_us = (uint64_t) (strtod(p_value, NULL) * 1000);
+        } else if (strcmp(p_option, "--role") == 0) {
+            if (strcmp(p_value, "relay") == 0) {
+                m_options.role = TIME_ROLE_RELAY;
+            } else if (strcmp(p_value, "client") == 0) {
+                m_options.role = TIME_ROLE_CLIENT;
+            } else {
+                usage();
+            }
+        } else if (strcmp(p_option, "--ttl") == 0) {
+            m_options.ttl = (uint8_t) strtoul(p_value, NULL, 0);
+        } else if (strcmp(p_option, "--clients") == 0) {
+            m_options.clients = (uint32_t) strtoul(p_value, NULL, 0);
+        } else if (strcmp(p_option, "--get-interval") == 0) {
+            m_options.get_interval_us = (uint64_t) (strtod(p_value, NULL) * US_PER_SEC);
+        } else if (strcmp(p_option, "--seed") == 0) {
+            m_options.seed = strtoull(p_value, NULL, 0);
+        } else if (strcmp(p_option, "--threads") == 0) {
+            m_options.threads = (uint32_t) strtoul(p_value, NULL, 0);
+        } else if (strcmp(p_option, "--scaling") == 0) {
+            m_options.scaling = (uint32_t) strtoul(p_value, NULL, 0);
+        } else {
+            usage();
+        }
+    }
+
+    if (m_options.nodes < 2 || m_options.nodes > SIM_NODES_MAX || m_options.publish_interval_us == 0 ||
+        m_options.get_interval_us == 0 || m_options.clients >= m_options.nodes || m_options.threads == 0 ||
+        m_options.threads > SIM_THREADS_MAX || m_options.scaling > SIM_THREADS_MAX) {
+        usage();
+    }
+    /* Without a shortest delay, the threads would have to synchronize after each event */
+    if ((m_options.threads > 1 || m_options.scaling > 1) && m_options.delay_us == 0) {
+        usage();
+    }
+}
+
+int main(int argc, char ** argv) {
+    result_t result;
+
+    options_parse(argc, argv);
+
+    if (m_options.scaling == 0) {
+        bool converged = simulate(m_options.threads, true, &result);
+        return (m_options.check && !converged) ? 1 : 0;
+    }
+
+    result_t reference;
+    int status = 0;
+    simulate(1, true, &reference);
+    printf("\nthreads     wall s   speedup   checksum\n");
+    printf("%7u %10.3f %9.2f   %016" PRIx64 "\n", 1, reference.wall_s, 1.0, reference.checksum);
+    for (uint32_t threads = 2; threads <= m_options.scaling; threads *= 2) {
+        simulate(threads, false, &result);
+        printf("%7u %10.3f %9.2f   %016" PRIx64 "%s\n", threads, result.wall_s, reference.wall_s / result.wall_s,
+               result.checksum, result.checksum == reference.checksum ? "" : "   differs");
+        if (result.checksum != reference.checksum) {
+            status = 1;
+        }
+    }
+    return status;
+}
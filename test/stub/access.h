@@ -0,0 +1,83 @@
+/* Stand-in for the mesh SDK header of the same name, for the host build in test/ */
+#ifndef ACCESS_H
+#define ACCESS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "device_state_manager.h"
+#include "nrf_mesh.h"
+
+#define ACCESS_COMPANY_ID_NONE (0xFFFF)
+
+#define ACCESS_OPCODE_SIG(opcode) {(opcode), ACCESS_COMPANY_ID_NONE}
+
+#define ACCESS_MODEL_SIG(id) {.company_id = ACCESS_COMPANY_ID_NONE, .model_id = (id)}
+
+typedef uint16_t access_model_handle_t;
+
+typedef struct {
+    uint16_t opcode;
+    uint16_t company_id;
+} access_opcode_t;
+
+typedef struct {
+    uint16_t company_id;
+    uint16_t model_id;
+} access_model_id_t;
+
+typedef struct {
+    nrf_mesh_address_t src;
+    nrf_mesh_address_t dst;
+    uint8_t ttl;
+    dsm_handle_t appkey_handle;
+    const nrf_mesh_rx_metadata_t * p_core_metadata;
+    dsm_handle_t subnet_handle;
+} access_message_rx_meta_t;
+
+typedef struct {
+    access_opcode_t opcode;
+    const uint8_t * p_data;
+    uint16_t length;
+    access_message_rx_meta_t meta_data;
+} access_message_rx_t;
+
+typedef struct {
+    access_opcode_t opcode;
+    const uint8_t * p_buffer;
+    uint16_t length;
+    bool force_segmented;
+    nrf_mesh_transmic_size_t transmic_size;
+    nrf_mesh_tx_token_t access_token;
+} access_message_tx_t;
+
+typedef void (*access_opcode_handler_cb_t)(access_model_handle_t handle,
+                                           const access_message_rx_t * p_message,
+                                           void * p_args);
+
+typedef struct {
+    access_opcode_t opcode;
+    access_opcode_handler_cb_t handler;
+} access_opcode_handler_t;
+
+typedef void (*access_publish_timeout_cb_t)(access_model_handle_t handle, void * p_args);
+
+typedef struct {
+    access_model_id_t model_id;
+    uint16_t element_index;
+    const access_opcode_handler_t * p_opcode_handlers;
+    uint32_t opcode_count;
+    void * p_args;
+    access_publish_timeout_cb_t publish_timeout_cb;
+} access_model_add_params_t;
+
+uint32_t access_model_add(const access_model_add_params_t * p_model_params, access_model_handle_t * p_model_handle);
+uint32_t access_model_subscription_list_alloc(access_model_handle_t handle);
+uint32_t access_model_publish(access_model_handle_t handle, const access_message_tx_t * p_message);
+uint32_t access_model_reply(access_model_handle_t handle, const access_message_rx_t * p_message,
+                            const access_message_tx_t * p_reply);
+uint32_t access_model_publish_ttl_set(access_model_handle_t handle, uint8_t ttl);
+uint32_t access_model_publish_ttl_get(access_model_handle_t handle, uint8_t * p_ttl);
+uint32_t access_model_publish_application_get(access_model_handle_t handle, dsm_handle_t * p_appkey_handle);
+
+#endif
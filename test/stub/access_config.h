@@ -0,0 +1 @@
+#include "access.h"
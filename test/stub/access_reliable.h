@@ -0,0 +1,31 @@
+/* Stand-in for the mesh SDK header of the same name, for the host build in test/ */
+#ifndef ACCESS_RELIABLE_H
+#define ACCESS_RELIABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "access.h"
+
+typedef enum {
+    ACCESS_RELIABLE_TRANSFER_SUCCESS,
+    ACCESS_RELIABLE_TRANSFER_TIMEOUT,
+    ACCESS_RELIABLE_TRANSFER_CANCELLED
+} access_reliable_status_t;
+
+typedef void (*access_reliable_cb_t)(access_model_handle_t model_handle, void * p_args,
+                                     access_reliable_status_t status);
+
+typedef struct {
+    access_model_handle_t model_handle;
+    access_message_tx_t message;
+    access_opcode_t reply_opcode;
+    uint32_t timeout;
+    access_reliable_cb_t status_cb;
+} access_reliable_t;
+
+uint32_t access_model_reliable_publish(const access_reliable_t * p_reliable);
+uint32_t access_model_reliable_cancel(access_model_handle_t model_handle);
+bool access_reliable_model_is_free(access_model_handle_t model_handle);
+
+#endif
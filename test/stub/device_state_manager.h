@@ -0,0 +1,24 @@
+/* Stand-in for the mesh SDK header of the same name, for the host build in test/ */
+#ifndef DEVICE_STATE_MANAGER_H
+#define DEVICE_STATE_MANAGER_H
+
+#include <stdint.h>
+
+#include "nrf_mesh.h"
+
+typedef uint16_t dsm_handle_t;
+
+#define DSM_HANDLE_INVALID (0xFFFF)
+
+typedef struct {
+    uint16_t address_start;
+    uint16_t count;
+} dsm_local_unicast_address_t;
+
+/** Gives the address of the current node of the stand-in, see mesh_stub_node_set() */
+void dsm_local_unicast_addresses_get(dsm_local_unicast_address_t * p_address);
+
+/** All the application keys of the stand-in belong to the subnet of handle 0 */
+uint32_t dsm_appkey_handle_to_subnet_handle(dsm_handle_t appkey_handle, dsm_handle_t * p_netkey_handle);
+
+#endif
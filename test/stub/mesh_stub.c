@@ -0,0 +1,457 @@
+#include "mesh_stub.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "access.h"
+#include "access_reliable.h"
+#include "app_timer.h"
+#include "device_state_manager.h"
+#include "nrf_mesh.h"
+#include "timer.h"
+#include "timer_scheduler.h"
+
+typedef struct {
+    access_model_add_params_t params;
+    uint16_t node;
+    uint16_t publish_address;
+    dsm_handle_t publish_appkey;
+    uint8_t ttl;
+    /** Acknowledged transaction in progress, with its deadline */
+    bool reliable_active;
+    access_reliable_t reliable;
+    uint64_t reliable_deadline;
+} model_t;
+
+static model_t * m_models;
+static uint32_t m_model_count;
+static uint32_t m_model_capacity;
+
+static mesh_stub_tx_cb_t m_tx_cb;
+static uint32_t m_publish_status = NRF_SUCCESS;
+
+static app_timer_t * mp_app_timers;
+static timer_event_t * mp_timer_events;
+
+static _Thread_local uint16_t m_node;
+static _Thread_local uint64_t m_time_us;
+static _Thread_local mesh_stub_tx_t m_last_tx;
+
+static inline uint64_t ticks_to_us(uint64_t ticks) {
+    return (ticks * 1000000 + APP_TIMER_CLOCK_FREQ - 1) / APP_TIMER_CLOCK_FREQ;
+}
+
+static inline uint64_t ticks_now(void) {
+    return m_time_us * APP_TIMER_CLOCK_FREQ / 1000000;
+}
+
+static void tx(access_model_handle_t handle, uint16_t dst, uint8_t ttl, const access_message_tx_t * p_message) {
+    m_last_tx.handle = handle;
+    m_last_tx.opcode = p_message->opcode.opcode;
+    m_last_tx.dst = dst;
+    m_last_tx.ttl = ttl;
+    m_last_tx.length = p_message->length;
+    if (p_message->length <= MESH_STUB_MESSAGE_MAXLEN && p_message->length > 0) {
+        memcpy(m_last_tx.data, p_message->p_buffer, p_message->length);
+    }
+    m_last_tx.count++;
+
+    if (m_tx_cb != NULL) {
+        m_tx_cb(handle, m_models[handle].node, dst, ttl, p_message);
+    }
+}
+
+void mesh_stub_reset(void) {
+    free(m_models);
+    m_models = NULL;
+    m_model_count = 0;
+    m_model_capacity = 0;
+    m_tx_cb = NULL;
+    m_publish_status = NRF_SUCCESS;
+    mp_app_timers = NULL;
+    while (mp_timer_events != NULL) {
+        mp_timer_events->active = false;
+        mp_timer_events = mp_timer_events->p_next;
+    }
+    m_node = 0;
+    m_time_us = 0;
+    memset(&m_last_tx, 0, sizeof(m_last_tx));
+}
+
+void mesh_stub_node_set(uint16_t address) {
+    m_node = address;
+}
+
+uint16_t mesh_stub_model_node_get(access_model_handle_t handle) {
+    return m_models[handle].node;
+}
+
+void mesh_stub_tx_cb_set(mesh_stub_tx_cb_t tx_cb) {
+    m_tx_cb = tx_cb;
+}
+
+void mesh_stub_publish_address_set(access_model_handle_t handle, uint16_t address) {
+    m_models[handle].publish_address = address;
+}
+
+void mesh_stub_publish_appkey_set(access_model_handle_t handle, dsm_handle_t appkey_handle) {
+    m_models[handle].publish_appkey = appkey_handle;
+}
+
+void mesh_stub_publish_status_set(uint32_t status) {
+    m_publish_status = status;
+}
+
+uint32_t mesh_stub_rx(access_model_handle_t handle, uint16_t opcode, const uint8_t * p_data, uint16_t length,
+                      uint16_t src, uint8_t ttl) {
+    model_t * p_model = &m_models[handle];
+    const access_opcode_handler_t * p_handler = NULL;
+
+    for (uint32_t i = 0; i < p_model->params.opcode_count; i++) {
+        if (p_model->params.p_opcode_handlers[i].opcode.opcode == opcode) {
+            p_handler = &p_model->params.p_opcode_handlers[i];
+            break;
+        }
+    }
+    if (p_handler == NULL) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    access_message_rx_t message = {
+        .opcode = ACCESS_OPCODE_SIG(opcode),
+        .p_data = p_data,
+        .length = length,
+        .meta_data = {
+            .src = {.type = NRF_MESH_ADDRESS_TYPE_UNICAST, .value = src},
+            .dst = {.type = NRF_MESH_ADDRESS_TYPE_UNICAST, .value = p_model->node},
+            .ttl = ttl,
+            .appkey_handle = 0,
+            .p_core_metadata = NULL,
+            .subnet_handle = 0
+        }
+    };
+
+    uint16_t node = m_node;
+    m_node = p_model->node;
+    p_handler->handler(handle, &message, p_model->params.p_args);
+
+    /* The reply of an acknowledged transaction ends it, after its handler */
+    if (p_model->reliable_active && p_model->reliable.reply_opcode.opcode == opcode) {
+        p_model->reliable_active = false;
+        if (p_model->reliable.status_cb != NULL) {
+            p_model->reliable.status_cb(handle, p_model->params.p_args, ACCESS_RELIABLE_TRANSFER_SUCCESS);
+        }
+    }
+    m_node = node;
+    return NRF_SUCCESS;
+}
+
+void mesh_stub_publish_timeout(access_model_handle_t handle) {
+    model_t * p_model = &m_models[handle];
+
+    if (p_model->params.publish_timeout_cb != NULL) {
+        uint16_t node = m_node;
+        m_node = p_model->node;
+        p_model->params.publish_timeout_cb(handle, p_model->params.p_args);
+        m_node = node;
+    }
+}
+
+const mesh_stub_tx_t * mesh_stub_last_tx(void) {
+    return &m_last_tx;
+}
+
+void mesh_stub_time_set(uint64_t time_us) {
+    m_time_us = time_us;
+}
+
+uint64_t mesh_stub_time_get(void) {
+    return m_time_us;
+}
+
+void mesh_stub_run(uint64_t time_us) {
+    for (;;) {
+        /* Earliest timer, timer scheduler event or transaction deadline until time_us */
+        uint64_t next = time_us + 1;
+        app_timer_t * p_timer = NULL;
+        timer_event_t * p_event = NULL;
+        model_t * p_reliable = NULL;
+
+        for (app_timer_t * p = mp_app_timers; p != NULL; p = p->p_next) {
+            if (p->active && ticks_to_us(p->expiry) < next) {
+                next = ticks_to_us(p->expiry);
+                p_timer = p;
+            }
+        }
+        for (timer_event_t * p = mp_timer_events; p != NULL; p = p->p_next) {
+            if (p->active && p->expiry_us < next) {
+                next = p->expiry_us;
+                p_event = p;
+                p_timer = NULL;
+            }
+        }
+        for (uint32_t i = 0; i < m_model_count; i++) {
+            if (m_models[i].reliable_active && m_models[i].reliable_deadline < next) {
+                next = m_models[i].reliable_deadline;
+                p_reliable = &m_models[i];
+                p_timer = NULL;
+                p_event = NULL;
+            }
+        }
+        if (next > time_us) {
+            break;
+        }
+        if (next > m_time_us) {
+            m_time_us = next;
+        }
+
+        if (p_reliable != NULL) {
+            access_model_handle_t handle = (access_model_handle_t) (p_reliable - m_models);
+            p_reliable->reliable_active = false;
+            m_node = p_reliable->node;
+            if (p_reliable->reliable.status_cb != NULL) {
+                p_reliable->reliable.status_cb(handle, p_reliable->params.p_args, ACCESS_RELIABLE_TRANSFER_TIMEOUT);
+            }
+        } else if (p_event != NULL) {
+            timestamp_t timestamp = p_event->timestamp;
+            if (p_event->interval > 0) {
+                p_event->timestamp += p_event->interval;
+                p_event->expiry_us += p_event->interval;
+            } else {
+                timer_sch_abort(p_event);
+            }
+            p_event->cb(timestamp, p_event->p_context);
+        } else {
+            if (p_timer->mode == APP_TIMER_MODE_REPEATED) {
+                p_timer->expiry += p_timer->interval;
+            } else {
+                p_timer->active = false;
+            }
+            p_timer->handler(p_timer->p_context);
+        }
+    }
+    m_time_us = time_us;
+}
+
+/*********************************************************************
+    SDK STAND-IN
+**********************************************************************/
+
+nrf_mesh_tx_token_t nrf_mesh_unique_token_get(void) {
+    static nrf_mesh_tx_token_t token;
+    return __atomic_add_fetch(&token, 1, __ATOMIC_RELAXED);
+}
+
+timestamp_t timer_now(void) {
+    return (timestamp_t) m_time_us;
+}
+
+void dsm_local_unicast_addresses_get(dsm_local_unicast_address_t * p_address) {
+    p_address->address_start = m_node;
+    p_address->count = 1;
+}
+
+uint32_t dsm_appkey_handle_to_subnet_handle(dsm_handle_t appkey_handle, dsm_handle_t * p_netkey_handle) {
+    if (appkey_handle == DSM_HANDLE_INVALID) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    *p_netkey_handle = 0;
+    return NRF_SUCCESS;
+}
+
+void timer_sch_schedule(timer_event_t * p_timer_evt) {
+    /* The 32-bit timestamp is taken as the closest one to the current time */
+    int32_t delay_us = (int32_t) (p_timer_evt->timestamp - (timestamp_t) m_time_us);
+    p_timer_evt->expiry_us = delay_us > 0 ? m_time_us + (uint64_t) delay_us : m_time_us;
+
+    if (!p_timer_evt->active) {
+        p_timer_evt->active = true;
+        p_timer_evt->p_next = mp_timer_events;
+        mp_timer_events = p_timer_evt;
+    }
+}
+
+void timer_sch_abort(timer_event_t * p_timer_evt) {
+    for (timer_event_t ** pp = &mp_timer_events; *pp != NULL; pp = &(*pp)->p_next) {
+        if (*pp == p_timer_evt) {
+            *pp = p_timer_evt->p_next;
+            break;
+        }
+    }
+    p_timer_evt->active = false;
+}
+
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp) {
+    p_timer_evt->timestamp = new_timestamp;
+    timer_sch_schedule(p_timer_evt);
+}
+
+uint32_t access_model_add(const access_model_add_params_t * p_model_params, access_model_handle_t * p_model_handle) {
+    if (p_model_params == NULL || p_model_handle == NULL) {
+        return NRF_ERROR_NULL;
+    }
+    if (m_model_count > UINT16_MAX) {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    if (m_model_count == m_model_capacity) {
+        uint32_t capacity = m_model_capacity == 0 ? 16 : m_model_capacity * 2;
+        model_t * p_models = realloc(m_models, capacity * sizeof(model_t));
+        if (p_models == NULL) {
+            return NRF_ERROR_NO_MEM;
+        }
+        m_models = p_models;
+        m_model_capacity = capacity;
+    }
+
+    model_t * p_model = &m_models[m_model_count];
+    memset(p_model, 0, sizeof(model_t));
+    p_model->params = *p_model_params;
+    p_model->node = m_node;
+    p_model->publish_address = NRF_MESH_ADDR_UNASSIGNED;
+    p_model->publish_appkey = 0;
+    p_model->ttl = MESH_STUB_DEFAULT_TTL;
+
+    *p_model_handle = (access_model_handle_t) m_model_count++;
+    return NRF_SUCCESS;
+}
+
+uint32_t access_model_subscription_list_alloc(access_model_handle_t handle) {
+    return handle < m_model_count ? NRF_SUCCESS : NRF_ERROR_NOT_FOUND;
+}
+
+uint32_t access_model_publish(access_model_handle_t handle, const access_message_tx_t * p_message) {
+    if (handle >= m_model_count) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (m_publish_status != NRF_SUCCESS) {
+        return m_publish_status;
+    }
+    tx(handle, m_models[handle].publish_address, m_models[handle].ttl, p_message);
+    return NRF_SUCCESS;
+}
+
+uint32_t access_model_reply(access_model_handle_t handle, const access_message_rx_t * p_message,
+                            const access_message_tx_t * p_reply) {
+    if (handle >= m_model_count) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    if (m_publish_status != NRF_SUCCESS) {
+        return m_publish_status;
+    }
+    /* A message received with a TTL of 0 is answered with a TTL of 0, like in the SDK */
+    tx(handle, p_message->meta_data.src.value, p_message->meta_data.ttl == 0 ? 0 : m_models[handle].ttl, p_reply);
+    return NRF_SUCCESS;
+}
+
+uint32_t access_model_publish_ttl_set(access_model_handle_t handle, uint8_t ttl) {
+    if (handle >= m_model_count) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    m_models[handle].ttl = ttl;
+    return NRF_SUCCESS;
+}
+
+uint32_t access_model_publish_ttl_get(access_model_handle_t handle, uint8_t * p_ttl) {
+    if (handle >= m_model_count) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    *p_ttl = m_models[handle].ttl;
+    return NRF_SUCCESS;
+}
+
+uint32_t access_model_publish_application_get(access_model_handle_t handle, dsm_handle_t * p_appkey_handle) {
+    if (handle >= m_model_count) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    *p_appkey_handle = m_models[handle].publish_appkey;
+    return NRF_SUCCESS;
+}
+
+uint32_t access_model_reliable_publish(const access_reliable_t * p_reliable) {
+    if (p_reliable == NULL) {
+        return NRF_ERROR_NULL;
+    }
+    if (p_reliable->model_handle >= m_model_count) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    model_t * p_model = &m_models[p_reliable->model_handle];
+    if (p_model->reliable_active) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    uint32_t status = access_model_publish(p_reliable->model_handle, &p_reliable->message);
+    if (status == NRF_SUCCESS) {
+        p_model->reliable_active = true;
+        p_model->reliable = *p_reliable;
+        p_model->reliable_deadline = m_time_us + p_reliable->timeout;
+    }
+    return status;
+}
+
+uint32_t access_model_reliable_cancel(access_model_handle_t model_handle) {
+    if (model_handle >= m_model_count || !m_models[model_handle].reliable_active) {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    model_t * p_model = &m_models[model_handle];
+    p_model->reliable_active = false;
+    if (p_model->reliable.status_cb != NULL) {
+        p_model->reliable.status_cb(model_handle, p_model->params.p_args, ACCESS_RELIABLE_TRANSFER_CANCELLED);
+    }
+    return NRF_SUCCESS;
+}
+
+bool access_reliable_model_is_free(access_model_handle_t model_handle) {
+    return model_handle < m_model_count && !m_models[model_handle].reliable_active;
+}
+
+ret_code_t app_timer_create(app_timer_id_t const * p_timer_id, app_timer_mode_t mode,
+                            app_timer_timeout_handler_t timeout_handler) {
+    if (p_timer_id == NULL || timeout_handler == NULL) {
+        return NRF_ERROR_NULL;
+    }
+
+    app_timer_t * p_timer = *p_timer_id;
+    p_timer->handler = timeout_handler;
+    p_timer->mode = mode;
+    p_timer->active = false;
+
+    for (app_timer_t * p = mp_app_timers; p != NULL; p = p->p_next) {
+        if (p == p_timer) {
+            return NRF_SUCCESS;
+        }
+    }
+    p_timer->p_next = mp_app_timers;
+    mp_app_timers = p_timer;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context) {
+    if (timer_id->handler == NULL) {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS || timeout_ticks > APP_TIMER_MAX_CNT_VAL) {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    timer_id->active = true;
+    timer_id->expiry = ticks_now() + timeout_ticks;
+    timer_id->interval = timeout_ticks;
+    timer_id->p_context = p_context;
+    return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id) {
+    timer_id->active = false;
+    return NRF_SUCCESS;
+}
+
+uint32_t app_timer_cnt_get(void) {
+    return (uint32_t) (ticks_now() & APP_TIMER_MAX_CNT_VAL);
+}
+
+uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from) {
+    return (ticks_to - ticks_from) & APP_TIMER_MAX_CNT_VAL;
+}
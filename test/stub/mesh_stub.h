@@ -0,0 +1,97 @@
+/**
+ * @file mesh_stub.h
+ * @brief Control of the stand-in for the mesh SDK used by the host build in test/
+ *
+ * @details The stand-in implements the SDK calls listed in README.md in process: the models added with
+ * access_model_add() are kept in a table and reached through their opcode handler tables with
+ * mesh_stub_rx(), and everything they send goes to one callback set by the test. Each model belongs to
+ * the node that was current when it was added, whose address dsm_local_unicast_addresses_get() gives.
+ *
+ * The current node, the time and the last message sent are kept per thread, so that models of different
+ * nodes can be run on different threads once they are all added. The app timers, the timer scheduler events
+ * and the acknowledged transactions are not, and mesh_stub_run() is only used from one thread.
+ */
+#ifndef MESH_STUB_H
+#define MESH_STUB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "access.h"
+
+/** TTL of the messages of a model until access_model_publish_ttl_set() is called */
+#define MESH_STUB_DEFAULT_TTL (5)
+
+/** Largest message the stand-in keeps a copy of */
+#define MESH_STUB_MESSAGE_MAXLEN (32)
+
+/**
+ * Called for each message sent by a model
+ *
+ * @param[in]   handle      Model sending the message
+ * @param[in]   src         Address of the node of the model
+ * @param[in]   dst         Publish address of the model, or source of the message replied to
+ * @param[in]   ttl         TTL of the message
+ * @param[in]   p_message   Message
+ */
+typedef void (*mesh_stub_tx_cb_t)(access_model_handle_t handle, uint16_t src, uint16_t dst, uint8_t ttl,
+                                  const access_message_tx_t * p_message);
+
+/** Last message sent on the calling thread */
+typedef struct {
+    access_model_handle_t handle;
+    uint16_t opcode;
+    uint16_t dst;
+    uint8_t ttl;
+    uint16_t length;
+    uint8_t data[MESH_STUB_MESSAGE_MAXLEN];
+    /** Number of messages sent on the calling thread */
+    uint32_t count;
+} mesh_stub_tx_t;
+
+/** Forgets all the models and timers, and sets the time back to 0 */
+void mesh_stub_reset(void);
+
+/** Sets the address of the node the models added next, and the handlers called next, belong to */
+void mesh_stub_node_set(uint16_t address);
+
+/** Address of the node of a model */
+uint16_t mesh_stub_model_node_get(access_model_handle_t handle);
+
+/** Sets the callback of the messages sent, or NULL to only record them in mesh_stub_last_tx() */
+void mesh_stub_tx_cb_set(mesh_stub_tx_cb_t tx_cb);
+
+/** Sets the address a model publishes to, NRF_MESH_ADDR_UNASSIGNED until then */
+void mesh_stub_publish_address_set(access_model_handle_t handle, uint16_t address);
+
+/** Sets the application key a model publishes with, 0 until then */
+void mesh_stub_publish_appkey_set(access_model_handle_t handle, dsm_handle_t appkey_handle);
+
+/** Makes access_model_publish() and access_model_reply() of all the models fail with a status, or succeed with NRF_SUCCESS */
+void mesh_stub_publish_status_set(uint32_t status);
+
+/**
+ * Delivers a message to a model through its opcode handler table, on the node of the model
+ *
+ * @retval NRF_SUCCESS          The handler of the opcode was called.
+ * @retval NRF_ERROR_NOT_FOUND  The model has no handler for the opcode.
+ */
+uint32_t mesh_stub_rx(access_model_handle_t handle, uint16_t opcode, const uint8_t * p_data, uint16_t length,
+                      uint16_t src, uint8_t ttl);
+
+/** Calls the periodic publication callback of a model */
+void mesh_stub_publish_timeout(access_model_handle_t handle);
+
+/** Last message sent on the calling thread */
+const mesh_stub_tx_t * mesh_stub_last_tx(void);
+
+/** Sets the time of the calling thread, in microseconds, without running the timers */
+void mesh_stub_time_set(uint64_t time_us);
+
+/** Time of the calling thread, in microseconds */
+uint64_t mesh_stub_time_get(void);
+
+/** Moves the time on to time_us, running the timers which expire until then in order */
+void mesh_stub_run(uint64_t time_us);
+
+#endif
@@ -0,0 +1,11 @@
+/* Stand-in for the mesh SDK header of the same name, for the host build in test/ */
+#ifndef MODEL_COMMON_H
+#define MODEL_COMMON_H
+
+#include "access.h"
+#include "access_reliable.h"
+
+/** Default timeout of the acknowledged transactions, in microseconds */
+#define MODEL_ACKNOWLEDGED_TRANSACTION_TIMEOUT (30000000)
+
+#endif
@@ -0,0 +1,76 @@
+/* Stand-in for the mesh SDK header of the same name, for the host build in test/ */
+#ifndef NRF_MESH_H
+#define NRF_MESH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nrf_error.h"
+#include "timer.h"
+
+#define NRF_MESH_ADDR_UNASSIGNED (0x0000)
+
+#ifndef ARRAY_SIZE
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#endif
+
+typedef enum {
+    NRF_MESH_TRANSMIC_SIZE_SMALL,
+    NRF_MESH_TRANSMIC_SIZE_LARGE,
+    NRF_MESH_TRANSMIC_SIZE_DEFAULT = NRF_MESH_TRANSMIC_SIZE_SMALL
+} nrf_mesh_transmic_size_t;
+
+typedef enum {
+    NRF_MESH_ADDRESS_TYPE_INVALID,
+    NRF_MESH_ADDRESS_TYPE_UNICAST,
+    NRF_MESH_ADDRESS_TYPE_VIRTUAL,
+    NRF_MESH_ADDRESS_TYPE_GROUP
+} nrf_mesh_address_type_t;
+
+typedef struct {
+    nrf_mesh_address_type_t type;
+    uint16_t value;
+    const uint8_t * p_virtual_uuid;
+} nrf_mesh_address_t;
+
+typedef uint32_t nrf_mesh_tx_token_t;
+
+typedef enum {
+    NRF_MESH_RX_SOURCE_SCANNER,
+    NRF_MESH_RX_SOURCE_GATT,
+    NRF_MESH_RX_SOURCE_FRIEND,
+    NRF_MESH_RX_SOURCE_LOW_POWER,
+    NRF_MESH_RX_SOURCE_INSTABURST,
+    NRF_MESH_RX_SOURCE_LOOPBACK
+} nrf_mesh_rx_source_t;
+
+typedef struct {
+    timestamp_t timestamp;
+    uint32_t access_addr;
+    uint8_t channel;
+    int8_t rssi;
+} nrf_mesh_rx_metadata_scanner_t;
+
+typedef struct {
+    nrf_mesh_rx_source_t source;
+    union {
+        nrf_mesh_rx_metadata_scanner_t scanner;
+    } params;
+} nrf_mesh_rx_metadata_t;
+
+static inline nrf_mesh_address_type_t nrf_mesh_address_type_get(uint16_t address) {
+    if (address == NRF_MESH_ADDR_UNASSIGNED) {
+        return NRF_MESH_ADDRESS_TYPE_INVALID;
+    } else if (address < 0x8000) {
+        return NRF_MESH_ADDRESS_TYPE_UNICAST;
+    } else if (address < 0xC000) {
+        return NRF_MESH_ADDRESS_TYPE_VIRTUAL;
+    } else {
+        return NRF_MESH_ADDRESS_TYPE_GROUP;
+    }
+}
+
+nrf_mesh_tx_token_t nrf_mesh_unique_token_get(void);
+
+#endif
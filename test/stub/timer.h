@@ -0,0 +1,15 @@
+/* Stand-in for the mesh SDK header of the same name, for the host build in test/ */
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+/** Timestamp in microseconds, wrapping like the 32-bit timer of the mesh stack */
+typedef uint32_t timestamp_t;
+
+#define TIMER_DIFF(time, ref) ((time) - (ref))
+
+/** Current time of the stand-in, see mesh_stub_time_set() */
+timestamp_t timer_now(void);
+
+#endif
@@ -0,0 +1,28 @@
+/* Stand-in for the mesh SDK header of the same name, for the host build in test/ */
+#ifndef TIMER_SCHEDULER_H
+#define TIMER_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "timer.h"
+
+typedef void (*timer_sch_callback_t)(timestamp_t timestamp, void * p_context);
+
+typedef struct timer_event {
+    timestamp_t timestamp;
+    timer_sch_callback_t cb;
+    /** Period of a periodic event, 0 for a single shot one */
+    uint32_t interval;
+    void * p_context;
+    /** Kept by the stand-in: time of the next expiry on its 64-bit clock, and the list of scheduled events */
+    uint64_t expiry_us;
+    bool active;
+    struct timer_event * p_next;
+} timer_event_t;
+
+void timer_sch_schedule(timer_event_t * p_timer_evt);
+void timer_sch_abort(timer_event_t * p_timer_evt);
+void timer_sch_reschedule(timer_event_t * p_timer_evt, timestamp_t new_timestamp);
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file test_calendar.c
+ * @brief Civil time conversions of time_model_calendar.h, and their cost
+ *
+ * @details Checks the conversions against gmtime() over the whole TAI time range, their round trips, the
+ * leap seconds of the table, and that the batch conversions give the same results as the scalar ones.
+ *
+ * Usage: test_calendar [conversions]
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "test_common.h"
+#include "time_model_calendar.h"
+#include "time_model_common.h"
+
+/** Unix time of 2000-01-01T00:00:00 UTC */
+#define UNIX_TIME_AT_EPOCH (946684800LL)
+
+#define BATCH_SIZE (1024)
+
+static uint64_t m_seed = 1;
+
+static uint64_t random_next(void) {
+    m_seed = m_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return m_seed >> 16;
+}
+
+static void gmtime_check(int64_t local_seconds, const time_model_civil_t * p_civil) {
+    time_t unix_time = (time_t) (local_seconds + UNIX_TIME_AT_EPOCH);
+    struct tm tm;
+
+    CHECK(gmtime_r(&unix_time, &tm) != NULL);
+    CHECK(p_civil->year == tm.tm_year + 1900 && p_civil->month == tm.tm_mon + 1 && p_civil->day == tm.tm_mday);
+    CHECK(p_civil->hour == tm.tm_hour && p_civil->minute == tm.tm_min && p_civil->second == tm.tm_sec);
+    CHECK(p_civil->weekday == tm.tm_wday);
+}
+
+static void leap_second_check(uint64_t tai_seconds_after, int32_t year, uint8_t month, uint8_t day) {
+    time_model_civil_t civil;
+    int32_t tai_utc_delta = time_model_leap_tai_utc_delta_get(tai_seconds_after);
+
+    CHECK(time_model_leap_tai_utc_delta_get(tai_seconds_after - 1) == tai_utc_delta - 1);
+
+    time_model_tai_to_civil_leap(tai_seconds_after - 2, 0, &civil);
+    CHECK(civil.year == year && civil.month == month && civil.day == day);
+    CHECK(civil.hour == 23 && civil.minute == 59 && civil.second == 59);
+
+    time_model_tai_to_civil_leap(tai_seconds_after - 1, 0, &civil);
+    CHECK(civil.year == year && civil.month == month && civil.day == day);
+    CHECK(civil.hour == 23 && civil.minute == 59 && civil.second == 60);
+
+    /* 23:59:60 given with the TAI-UTC Delta before the leap second is the leap second itself */
+    CHECK(time_model_civil_to_tai(&civil, tai_utc_delta - 1, 0) == tai_seconds_after - 1);
+
+    time_model_tai_to_civil_leap(tai_seconds_after, 0, &civil);
+    CHECK(civil.hour == 0 && civil.minute == 0 && civil.second == 0 && civil.day == 1);
+    CHECK(time_model_civil_to_tai(&civil, tai_utc_delta, 0) == tai_seconds_after);
+
+    /* In a time zone, the leap second is at the local time of the end of the UTC day */
+    time_model_tai_to_civil_leap(tai_seconds_after - 1, 4 * 9, &civil);
+    CHECK(civil.hour == 8 && civil.minute == 59 && civil.second == 60);
+}
+
+int main(int argc, char ** argv) {
+    uint32_t count = test_count_arg(argc, argv, 1000000);
+    time_model_civil_t civil;
+
+    /* The epoch, and dates around it */
+    CHECK(time_model_days_from_civil(2000, 1, 1) == 0);
+    CHECK(time_model_days_from_civil(1999, 12, 31) == -1);
+    CHECK(time_model_days_from_civil(2000, 3, 1) == 60);
+    time_model_tai_to_civil(0, 0, 0, &civil);
+    CHECK(civil.year == 2000 && civil.month == 1 && civil.day == 1 && civil.weekday == 6);
+    time_model_tai_to_civil(0, TAI_UTC_DELTA_AT_EPOCH, 0, &civil);
+    CHECK(civil.year == 1999 && civil.month == 12 && civil.day == 31 && civil.second == 28);
+
+    /* Every day of the valid years round trips */
+    int32_t first_day = time_model_days_from_civil(1, 1, 1);
+    int32_t last_day = time_model_days_from_civil(40000, 12, 31);
+    for (int32_t days = first_day; days <= last_day; days++) {
+        time_model_civil_from_days(days, &civil);
+        CHECK(time_model_days_from_civil(civil.year, civil.month, civil.day) == days);
+    }
+    time_model_civil_from_days(first_day, &civil);
+    CHECK(civil.year == 1 && civil.month == 1 && civil.day == 1);
+    time_model_civil_from_days(last_day, &civil);
+    CHECK(civil.year == 40000 && civil.month == 12 && civil.day == 31);
+
+    /* Times over the whole TAI range, in any time zone, match gmtime() and round trip */
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t tai_seconds = random_next() % (TAI_TIME_MAX_VAL + 1);
+        int32_t tai_utc_delta = (int32_t) (random_next() % 300);
+        int16_t time_zone_offset = (int16_t) (random_next() % 256) - 64;
+
+        time_model_tai_to_civil(tai_seconds, tai_utc_delta, time_zone_offset, &civil);
+        gmtime_check(time_model_tai_to_local(tai_seconds, tai_utc_delta, time_zone_offset), &civil);
+
+        CHECK(time_model_civil_to_tai(&civil, tai_utc_delta, time_zone_offset) == tai_seconds);
+    }
+
+    /* Times before the TAI epoch have no TAI time */
+    civil = (time_model_civil_t) {.year = 1999, .month = 12, .day = 31, .hour = 23, .minute = 59, .second = 59};
+    CHECK(time_model_civil_to_tai(&civil, 0, 0) == TAI_TIME_UNKNOWN);
+
+    /* The leap seconds of the table */
+    CHECK(time_model_leap_tai_utc_delta_get(0) == TAI_UTC_DELTA_AT_EPOCH);
+    leap_second_check(189388833, 2005, 12, 31);
+    leap_second_check(284083234, 2008, 12, 31);
+    leap_second_check(394416035, 2012, 6, 30);
+    leap_second_check(489024036, 2015, 6, 30);
+    leap_second_check(536544037, 2016, 12, 31);
+    CHECK(time_model_leap_tai_utc_delta_get(TAI_TIME_MAX_VAL) == 37);
+
+    /* The batch conversions give the same results as the scalar ones */
+    static uint64_t tai_seconds[BATCH_SIZE];
+    static int64_t local_seconds[BATCH_SIZE];
+    static int32_t year[BATCH_SIZE];
+    static uint8_t month[BATCH_SIZE];
+    static uint8_t day[BATCH_SIZE];
+    static uint32_t second_of_day[BATCH_SIZE];
+
+    for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+        tai_seconds[i] = random_next() % (TAI_TIME_MAX_VAL + 1);
+    }
+    time_model_tai_to_local_batch(tai_seconds, local_seconds, BATCH_SIZE, 37, -20);
+    time_model_tai_to_civil_batch(tai_seconds, BATCH_SIZE, 37, -20, year, month, day, second_of_day);
+    for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+        time_model_tai_to_civil(tai_seconds[i], 37, -20, &civil);
+        CHECK(local_seconds[i] == time_model_tai_to_local(tai_seconds[i], 37, -20));
+        CHECK(year[i] == civil.year && month[i] == civil.month && day[i] == civil.day);
+        CHECK(second_of_day[i] == civil.hour * 3600u + civil.minute * 60u + civil.second);
+    }
+
+    /* Cost of the conversions */
+    uint64_t checksum = 0;
+    uint64_t start = test_time_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        time_model_tai_to_civil(tai_seconds[i % BATCH_SIZE] + i, 37, 0, &civil);
+        checksum += civil.day;
+    }
+    uint64_t scalar_ns = test_time_ns() - start;
+
+    uint32_t batches = (count + BATCH_SIZE - 1) / BATCH_SIZE;
+    start = test_time_ns();
+    for (uint32_t i = 0; i < batches; i++) {
+        time_model_tai_to_civil_batch(tai_seconds, BATCH_SIZE, 37, (int16_t) (i & 7), year, month, day, second_of_day);
+        checksum += day[i % BATCH_SIZE];
+    }
+    uint64_t batch_ns = test_time_ns() - start;
+    CHECK(checksum > 0);
+
+    printf("test_calendar: %u conversions checked, %.1f ns/conversion, %.1f ns/conversion in batches\n", count,
+           (double) scalar_ns / count, (double) batch_ns / ((uint64_t) batches * BATCH_SIZE));
+    return 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file test_client_fleet.c
+ * @brief Fleet table of the Time Client, built with TIME_CLIENT_FLEET_TABLE_SIZE
+ *
+ * @details Checks the entries kept per node, the skew estimate, and that the local uptime of the entries stays
+ * consistent over hours without any Time Status, across several wraps of the 32-bit timer_now().
+ */
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_client.h"
+#include "time_model_messages.h"
+
+#define NODE_ADDRESS (0x0001)
+#define FIRST_SRC (0x0100)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+#define US_PER_SEC (1000000ULL)
+
+static time_client_t m_client = TIME_CLIENT_DEFAULT_SETTINGS;
+
+/** Receives a Time Status from src at the current time of the stand-in, with the time of the node ahead of it */
+static void status_rx(uint16_t src, int64_t ahead_us) {
+    uint64_t time_us = TAI_SECONDS_START * US_PER_SEC + mesh_stub_time_get() + ahead_us;
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint16_t length = test_time_msg_build(buffer, time_us / US_PER_SEC, (time_us % US_PER_SEC) * 256 / US_PER_SEC, 0,
+                                          true, 37 + 0xFF, 0x40);
+    CHECK(mesh_stub_rx(m_client.model_handle, TIME_OPCODE_STATUS, buffer, length, src, 0) == NRF_SUCCESS);
+}
+
+int main(void) {
+    mesh_stub_node_set(NODE_ADDRESS);
+    CHECK(time_client_init(&m_client, 0) == NRF_SUCCESS);
+    CHECK(time_client_fleet_count_get(&m_client) == 0 && time_client_fleet_find(&m_client, FIRST_SRC) == NULL);
+
+    /* One entry per node, in the order they were first heard from */
+    status_rx(FIRST_SRC + 1, 0);
+    status_rx(FIRST_SRC, 0);
+    status_rx(FIRST_SRC + 1, 0);
+    CHECK(time_client_fleet_count_get(&m_client) == 2);
+    CHECK(time_client_fleet_get(&m_client, 0)->src == FIRST_SRC + 1 && time_client_fleet_get(&m_client, 1)->src == FIRST_SRC);
+    CHECK(time_client_fleet_find(&m_client, FIRST_SRC + 1)->status_count == 2);
+    CHECK(time_client_fleet_get(&m_client, 2) == NULL);
+
+    /* Three hours without any Time Status, across wraps of timer_now() */
+    const time_client_fleet_entry_t * p_entry = time_client_fleet_find(&m_client, FIRST_SRC);
+    uint64_t rx_time_us = p_entry->rx_time_us;
+    int64_t time_base_us = p_entry->time_base_us;
+
+    mesh_stub_run(mesh_stub_time_get() + 3 * 3600 * US_PER_SEC);
+    status_rx(FIRST_SRC, 0);
+    CHECK(p_entry->rx_time_us - rx_time_us == 3 * 3600 * US_PER_SEC);
+    CHECK(p_entry->time_base_us == time_base_us);
+    CHECK(p_entry->skew_valid && p_entry->skew_ppb == 0);
+
+    /* A node running 100 ppm fast, measured to the 1/256 s of the Time Status */
+    uint64_t start_us = mesh_stub_time_get();
+    status_rx(FIRST_SRC + 2, 0);
+    const time_client_fleet_entry_t * p_fast = time_client_fleet_find(&m_client, FIRST_SRC + 2);
+    mesh_stub_run(start_us + 30 * US_PER_SEC);
+    status_rx(FIRST_SRC + 2, 3000);
+    CHECK(!p_fast->skew_valid);
+    mesh_stub_run(start_us + 625 * US_PER_SEC);
+    status_rx(FIRST_SRC + 2, 62500);
+    CHECK(p_fast->skew_valid && p_fast->skew_ppb == 100000);
+
+    /* A jump beyond TIME_CLIENT_FLEET_MAX_SKEW_PPM restarts the estimate */
+    mesh_stub_run(start_us + 1250 * US_PER_SEC);
+    status_rx(FIRST_SRC + 2, 3600 * US_PER_SEC);
+    CHECK(!p_fast->skew_valid);
+
+    /* Nodes beyond the table are counted, not recorded */
+    for (uint16_t i = 3; i < TIME_CLIENT_FLEET_TABLE_SIZE + 3; i++) {
+        status_rx(FIRST_SRC + i, 0);
+    }
+    CHECK(time_client_fleet_count_get(&m_client) == TIME_CLIENT_FLEET_TABLE_SIZE && m_client.fleet_dropped == 3);
+
+    time_client_fleet_clear(&m_client);
+    CHECK(time_client_fleet_count_get(&m_client) == 0 && time_client_fleet_find(&m_client, FIRST_SRC) == NULL);
+
+    printf("test_client_fleet: passed\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_client_queue.c
+ * @brief Queue of pipelined Time Get requests of the Time Client, built with TIME_CLIENT_REQUEST_QUEUE_SIZE
+ *
+ * @details Checks that the requests are sent in the order they were queued, up to max_in_flight at once, each
+ * to its own destination without touching the publication of the model, and that each one ends exactly once:
+ * with the Time Status of its destination, with a timeout, or with the error of the mesh stack.
+ */
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_client.h"
+#include "time_model_messages.h"
+
+#define NODE_ADDRESS (0x0001)
+#define GROUP_ADDRESS (0xC000)
+#define FIRST_DST (0x0100)
+#define PUBLISH_TTL (3)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+#define REQUEST_TIMEOUT_US (1000000)
+
+#define SENT_MAX (256)
+
+static time_client_t m_client = TIME_CLIENT_DEFAULT_SETTINGS;
+
+/** Destinations of the Time Get messages sent, in order */
+static uint16_t m_sent[SENT_MAX];
+static uint32_t m_sent_count;
+
+/** Requests ended, in order, with their status and the TAI seconds received */
+static struct {
+    uint16_t dst;
+    uint32_t status;
+    uint64_t tai_seconds;
+} m_ended[SENT_MAX];
+static uint32_t m_ended_count;
+
+static void tx_cb(access_model_handle_t handle, uint16_t src, uint16_t dst, uint8_t ttl,
+                  const access_message_tx_t * p_message) {
+    if (p_message->opcode.opcode == TIME_OPCODE_GET && dst != GROUP_ADDRESS) {
+        CHECK(src == NODE_ADDRESS && ttl == PUBLISH_TTL && m_sent_count < SENT_MAX);
+        m_sent[m_sent_count++] = dst;
+    }
+}
+
+static void request_cb(const time_client_t * p_self, uint16_t dst, uint32_t status, const time_status_params_t * p_in,
+                       void * p_context) {
+    CHECK(p_self == &m_client && m_ended_count < SENT_MAX);
+    CHECK((status == NRF_SUCCESS) == (p_in != NULL));
+    CHECK((uintptr_t) p_context == dst);
+
+    m_ended[m_ended_count].dst = dst;
+    m_ended[m_ended_count].status = status;
+    m_ended[m_ended_count].tai_seconds = p_in != NULL ? p_in->tai_seconds : 0;
+    m_ended_count++;
+}
+
+static uint32_t queue(uint16_t dst) {
+    return time_client_time_get_queue(&m_client, dst, request_cb, (void *) (uintptr_t) dst);
+}
+
+static void status_rx(uint16_t src) {
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint16_t length = test_time_msg_build(buffer, TAI_SECONDS_START + src, 0, 0, true, 37 + 0xFF, 0x40);
+    CHECK(mesh_stub_rx(m_client.model_handle, TIME_OPCODE_STATUS, buffer, length, src, 0) == NRF_SUCCESS);
+}
+
+int main(void) {
+    mesh_stub_node_set(NODE_ADDRESS);
+    mesh_stub_tx_cb_set(tx_cb);
+    m_client.settings.timeout = REQUEST_TIMEOUT_US;
+    m_client.settings.max_in_flight = 4;
+    CHECK(time_client_init(&m_client, 0) == NRF_SUCCESS);
+    mesh_stub_publish_address_set(m_client.model_handle, GROUP_ADDRESS);
+    CHECK(access_model_publish_ttl_set(m_client.model_handle, PUBLISH_TTL) == NRF_SUCCESS);
+
+    /* Arguments */
+    CHECK(queue(GROUP_ADDRESS) == NRF_ERROR_INVALID_ADDR);
+    CHECK(time_client_time_get_queue(&m_client, FIRST_DST, NULL, NULL) == NRF_ERROR_NULL);
+
+    /* Up to max_in_flight requests are sent at once, in order, the others wait */
+    for (uint16_t i = 0; i < 10; i++) {
+        CHECK(queue(FIRST_DST + i) == NRF_SUCCESS);
+    }
+    CHECK(m_sent_count == 4 && m_ended_count == 0);
+    for (uint16_t i = 0; i < 4; i++) {
+        CHECK(m_sent[i] == FIRST_DST + i);
+    }
+
+    /* The publication of the model is left as it was */
+    CHECK(time_client_time_get(&m_client) == NRF_SUCCESS);
+    CHECK(mesh_stub_last_tx()->dst == GROUP_ADDRESS);
+    CHECK(access_model_reliable_cancel(m_client.model_handle) == NRF_SUCCESS);
+
+    /* A Time Status ends the request to its source, from any position, and the next one is sent */
+    status_rx(FIRST_DST + 2);
+    CHECK(m_ended_count == 1 && m_ended[0].dst == FIRST_DST + 2 && m_ended[0].status == NRF_SUCCESS);
+    CHECK(m_ended[0].tai_seconds == TAI_SECONDS_START + FIRST_DST + 2);
+    CHECK(m_sent_count == 5 && m_sent[4] == FIRST_DST + 4);
+
+    /* A Time Status from a node without a request does not end any */
+    status_rx(FIRST_DST + 2);
+    status_rx(FIRST_DST + 9);
+    CHECK(m_ended_count == 1 && m_sent_count == 5);
+
+    for (uint16_t i = 0; i < 2; i++) {
+        status_rx(FIRST_DST + i);
+    }
+    CHECK(m_ended_count == 3 && m_sent_count == 7 && m_sent[5] == FIRST_DST + 5 && m_sent[6] == FIRST_DST + 6);
+
+    /* The requests nobody answers time out, each exactly once, and make room for the next ones */
+    uint64_t now_us = mesh_stub_time_get();
+    mesh_stub_run(now_us + REQUEST_TIMEOUT_US - 1);
+    CHECK(m_ended_count == 3);
+    mesh_stub_run(now_us + REQUEST_TIMEOUT_US);
+    CHECK(m_ended_count == 7 && m_sent_count == 10);
+    for (uint32_t i = 3; i < 7; i++) {
+        CHECK(m_ended[i].status == NRF_ERROR_TIMEOUT);
+    }
+    mesh_stub_run(now_us + 3 * REQUEST_TIMEOUT_US);
+    CHECK(m_ended_count == 10 && m_sent_count == 10);
+
+    /* Every request ended exactly once */
+    uint32_t ended_mask = 0;
+    for (uint32_t i = 0; i < m_ended_count; i++) {
+        CHECK(!(ended_mask & (1u << (m_ended[i].dst - FIRST_DST))));
+        ended_mask |= 1u << (m_ended[i].dst - FIRST_DST);
+    }
+    CHECK(ended_mask == 0x3FF);
+
+    /* The queue holds TIME_CLIENT_REQUEST_QUEUE_SIZE requests on top of the ones in flight */
+    m_sent_count = 0;
+    m_ended_count = 0;
+    for (uint16_t i = 0; i < 4 + TIME_CLIENT_REQUEST_QUEUE_SIZE; i++) {
+        CHECK(queue(FIRST_DST + i) == NRF_SUCCESS);
+    }
+    CHECK(queue(FIRST_DST) == NRF_ERROR_NO_MEM);
+    time_client_requests_cancel(&m_client);
+    CHECK(m_ended_count == 0);
+
+    /* Running out of buffers holds the queue back until a retry succeeds */
+    m_sent_count = 0;
+    mesh_stub_publish_status_set(NRF_ERROR_NO_MEM);
+    CHECK(queue(FIRST_DST) == NRF_SUCCESS);
+    CHECK(queue(FIRST_DST + 1) == NRF_SUCCESS);
+    now_us = mesh_stub_time_get();
+    mesh_stub_run(now_us + 5 * TIME_CLIENT_REQUEST_RETRY_DELAY_US);
+    CHECK(m_sent_count == 0 && m_ended_count == 0);
+    mesh_stub_publish_status_set(NRF_SUCCESS);
+    mesh_stub_run(now_us + 6 * TIME_CLIENT_REQUEST_RETRY_DELAY_US);
+    CHECK(m_sent_count == 2 && m_sent[0] == FIRST_DST && m_sent[1] == FIRST_DST + 1);
+    time_client_requests_cancel(&m_client);
+
+    /* ...but only for TIME_CLIENT_REQUEST_MAX_RETRIES retries in a row */
+    mesh_stub_publish_status_set(NRF_ERROR_NO_MEM);
+    CHECK(queue(FIRST_DST) == NRF_SUCCESS);
+    now_us = mesh_stub_time_get();
+    mesh_stub_run(now_us + (TIME_CLIENT_REQUEST_MAX_RETRIES + 1) * TIME_CLIENT_REQUEST_RETRY_DELAY_US);
+    CHECK(m_ended_count == 1 && m_ended[0].dst == FIRST_DST && m_ended[0].status == NRF_ERROR_NO_MEM);
+    mesh_stub_publish_status_set(NRF_SUCCESS);
+
+    /* Without an application key to publish with, a request cannot be sent */
+    m_ended_count = 0;
+    mesh_stub_publish_appkey_set(m_client.model_handle, DSM_HANDLE_INVALID);
+    CHECK(queue(FIRST_DST) == NRF_SUCCESS);
+    CHECK(m_ended_count == 1 && m_ended[0].status == NRF_ERROR_INVALID_STATE);
+
+    printf("test_client_queue: passed\n");
+    return 0;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file test_client_sweep.c
+ * @brief Adaptive fleet sweep of the Time Client, built with TIME_CLIENT_SWEEP
+ *
+ * @details Checks the window of the sweep growing with replies and halving on timeouts, that the sweep makes
+ * progress when the room it needs is freed by other requests, and that done_cb is called exactly once whether
+ * the sweep completes or is stopped.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_client.h"
+#include "time_model_messages.h"
+
+#define NODE_ADDRESS (0x0001)
+#define GROUP_ADDRESS (0xC000)
+#define FIRST_DST (0x0100)
+#define OTHER_DST (0x2000)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+#define REQUEST_TIMEOUT_US (1000000)
+
+static time_client_t m_client = TIME_CLIENT_DEFAULT_SETTINGS;
+
+static uint32_t m_result_count;
+static uint32_t m_done_count;
+static time_client_sweep_report_t m_report;
+
+static void result_cb(const time_client_t * p_self, uint16_t dst, uint32_t status, const time_status_params_t * p_in,
+                      void * p_context) {
+    CHECK(p_self == &m_client && p_context == NULL);
+    m_result_count++;
+}
+
+static void done_cb(const time_client_t * p_self, const time_client_sweep_report_t * p_report) {
+    CHECK(p_self == &m_client);
+    m_done_count++;
+    m_report = *p_report;
+}
+
+static void other_cb(const time_client_t * p_self, uint16_t dst, uint32_t status, const time_status_params_t * p_in,
+                     void * p_context) {
+}
+
+static void status_rx(uint16_t src) {
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint16_t length = test_time_msg_build(buffer, TAI_SECONDS_START, 0, 0, true, 37 + 0xFF, 0x40);
+    CHECK(mesh_stub_rx(m_client.model_handle, TIME_OPCODE_STATUS, buffer, length, src, 0) == NRF_SUCCESS);
+}
+
+/** Answers the requests in flight at the time of the call */
+static void answer_in_flight(void) {
+    uint16_t dsts[TIME_CLIENT_MAX_IN_FLIGHT];
+    uint8_t count = m_client.in_flight_count;
+
+    for (uint8_t i = 0; i < count; i++) {
+        dsts[i] = m_client.in_flight[i].dst;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        status_rx(dsts[i]);
+    }
+}
+
+/** Answers the requests in flight until the sweep is done */
+static void answer_until_done(void) {
+    for (uint32_t i = 0; i < 1000 && m_done_count == 0; i++) {
+        answer_in_flight();
+    }
+    CHECK(m_done_count == 1);
+}
+
+static void sweep_reset(void) {
+    m_result_count = 0;
+    m_done_count = 0;
+    memset(&m_report, 0, sizeof(m_report));
+}
+
+int main(void) {
+    mesh_stub_node_set(NODE_ADDRESS);
+    m_client.settings.timeout = REQUEST_TIMEOUT_US;
+    m_client.settings.max_in_flight = 4;
+    CHECK(time_client_init(&m_client, 0) == NRF_SUCCESS);
+    mesh_stub_publish_address_set(m_client.model_handle, GROUP_ADDRESS);
+
+    /* Arguments */
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST, NULL, done_cb) == NRF_ERROR_NULL);
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST + 1, FIRST_DST, result_cb, done_cb) ==
+          NRF_ERROR_INVALID_ADDR);
+    uint16_t list[] = {FIRST_DST, GROUP_ADDRESS};
+    CHECK(time_client_sweep_list_start(&m_client, list, 2, result_cb, done_cb) == NRF_ERROR_INVALID_ADDR);
+
+    /* The window starts at TIME_CLIENT_SWEEP_INITIAL_WINDOW and grows by one per window of replies */
+    sweep_reset();
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST + 199, result_cb, done_cb) == NRF_SUCCESS);
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST, result_cb, done_cb) == NRF_ERROR_INVALID_STATE);
+    CHECK(m_client.in_flight_count == TIME_CLIENT_SWEEP_INITIAL_WINDOW);
+    answer_until_done();
+    CHECK(m_result_count == 200 && !m_report.cancelled);
+    CHECK(m_report.node_count == 200 && m_report.reply_count == 200 && m_report.timeout_count == 0);
+    CHECK(m_report.window == TIME_CLIENT_MAX_IN_FLIGHT);
+    CHECK(m_client.settings.max_in_flight == 4);
+
+    /* A timeout halves the window, once for the requests that were in flight together */
+    sweep_reset();
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST + 99, result_cb, done_cb) == NRF_SUCCESS);
+    for (uint32_t i = 0; i < 1000 && m_client.sweep.window < 8; i++) {
+        answer_in_flight();
+    }
+    uint8_t in_flight = m_client.in_flight_count;
+    mesh_stub_run(mesh_stub_time_get() + REQUEST_TIMEOUT_US);
+    CHECK(m_report.timeout_count == 0 && m_client.sweep.report.timeout_count == in_flight);
+    CHECK(m_client.sweep.window == 4);
+    answer_until_done();
+    CHECK(m_result_count == 100 && m_report.reply_count + m_report.timeout_count == 100);
+
+    /* A sweep started on a full queue goes on as the other requests free their room */
+    sweep_reset();
+    for (uint16_t i = 0; i < 4 + TIME_CLIENT_REQUEST_QUEUE_SIZE; i++) {
+        CHECK(time_client_time_get_queue(&m_client, OTHER_DST + i, other_cb, NULL) == NRF_SUCCESS);
+    }
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST + 9, result_cb, done_cb) == NRF_SUCCESS);
+    CHECK(m_client.sweep.outstanding == 0);
+    answer_until_done();
+    CHECK(m_report.reply_count == 10);
+
+    /* Stopping a sweep reports what it got so far, once, and no more results */
+    sweep_reset();
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST + 99, result_cb, done_cb) == NRF_SUCCESS);
+    answer_in_flight();
+    time_client_sweep_stop(&m_client);
+    CHECK(m_done_count == 1 && m_report.cancelled && m_report.reply_count == TIME_CLIENT_SWEEP_INITIAL_WINDOW);
+    CHECK(m_client.settings.max_in_flight == 4);
+    uint32_t result_count = m_result_count;
+    answer_in_flight();
+    mesh_stub_run(mesh_stub_time_get() + 2 * REQUEST_TIMEOUT_US);
+    CHECK(m_done_count == 1 && m_result_count == result_count && m_client.in_flight_count == 0);
+    time_client_sweep_stop(&m_client);
+    CHECK(m_done_count == 1);
+
+    /* ...as does cancelling the requests */
+    sweep_reset();
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST + 99, result_cb, done_cb) == NRF_SUCCESS);
+    time_client_requests_cancel(&m_client);
+    CHECK(m_done_count == 1 && m_report.cancelled && m_report.reply_count == 0 && m_result_count == 0);
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST, result_cb, done_cb) == NRF_SUCCESS);
+    answer_in_flight();
+    CHECK(m_done_count == 2 && !m_report.cancelled && m_report.reply_count == 1);
+
+    /* A sweep of which every request fails to send ends right away, without going deeper per address */
+    sweep_reset();
+    mesh_stub_publish_status_set(NRF_ERROR_INVALID_STATE);
+    CHECK(time_client_sweep_range_start(&m_client, FIRST_DST, FIRST_DST + 4999, result_cb, done_cb) == NRF_SUCCESS);
+    CHECK(m_done_count == 1 && m_result_count == 5000 && m_report.error_count == 5000);
+    mesh_stub_publish_status_set(NRF_SUCCESS);
+
+    printf("test_client_sweep: passed\n");
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file test_clock.c
+ * @brief Accuracy of the fixed point time state under time_state_update_time_delta(), and its cost
+ *
+ * @details Adds a long run of mixed second and subsecond deltas to the time state, and checks after each
+ * one that the time read back is the exact sum, in 1/256 s, with the subseconds carried into the seconds.
+ *
+ * Usage: test_clock [deltas]
+ */
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_messages.h"
+#include "time_model_setup_server.h"
+
+#define NODE_ADDRESS (0x0001)
+#define PEER_ADDRESS (0x0002)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+static time_setup_server_t m_server = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+
+static void time_check(uint64_t time_256) {
+    uint64_t tai_seconds;
+    uint8_t subsecond;
+
+    CHECK(time_server_state_get_time(&m_server.time_server, &tai_seconds, &subsecond) == NRF_SUCCESS);
+    CHECK(tai_seconds == time_256 >> 8 && subsecond == (uint8_t) time_256);
+}
+
+int main(int argc, char ** argv) {
+    uint32_t count = test_count_arg(argc, argv, 1000000);
+    time_server_t * p_server = &m_server.time_server;
+
+    mesh_stub_node_set(NODE_ADDRESS);
+    CHECK(time_setup_server_init(&m_server, 0) == NRF_SUCCESS);
+
+    time_set_params_t time = {
+        .tai_seconds = TAI_SECONDS_START,
+        .subsecond = 0,
+        .tai_utc_delta = 37
+    };
+    CHECK(time_server_state_set_time(p_server, &time) == NRF_SUCCESS);
+
+    /* Subseconds carry into the seconds */
+    time_state_update_time_delta(p_server, 0, 200);
+    time_state_update_time_delta(p_server, 0, 100);
+    time_check((TAI_SECONDS_START << 8) + 300);
+
+    /* Mixed deltas, checked after each one */
+    uint64_t expected = (TAI_SECONDS_START << 8) + 300;
+    uint64_t seed = 1;
+    for (uint32_t i = 0; i < count; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint64_t delta_tai_seconds = (seed >> 60) & 3;
+        uint8_t delta_subsecond = (uint8_t) (seed >> 40);
+
+        time_state_update_time_delta(p_server, delta_tai_seconds, delta_subsecond);
+        expected += (delta_tai_seconds << 8) + delta_subsecond;
+        time_check(expected);
+    }
+
+    /* The Time Status carries the same time */
+    mesh_stub_rx(p_server->model_handle, TIME_OPCODE_GET, NULL, 0, PEER_ADDRESS, 0);
+    const mesh_stub_tx_t * p_tx = mesh_stub_last_tx();
+    CHECK(p_tx->length == TIME_STATUS_MAXLEN);
+    CHECK(test_get_le(p_tx->data, 5) == expected >> 8 && p_tx->data[5] == (uint8_t) expected);
+
+    /* Deltas beyond the 40-bit TAI range are rejected and leave the time as it was */
+    time.tai_seconds = TAI_TIME_MAX_VAL - 1;
+    time.subsecond = 0x80;
+    CHECK(time_server_state_set_time(p_server, &time) == NRF_SUCCESS);
+    time_state_update_time_delta(p_server, 1, 0x80);
+    time_check(((uint64_t) (TAI_TIME_MAX_VAL - 1) << 8) + 0x80);
+    time_state_update_time_delta(p_server, 1, 0x7F);
+    time_check(((uint64_t) TAI_TIME_MAX_VAL << 8) + 0xFF);
+
+    /* Cost of an update alone */
+    time.tai_seconds = TAI_SECONDS_START;
+    time.subsecond = 0;
+    CHECK(time_server_state_set_time(p_server, &time) == NRF_SUCCESS);
+
+    uint64_t start = test_time_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        time_state_update_time_delta(p_server, i & 1, (uint8_t) i);
+    }
+    uint64_t elapsed_ns = test_time_ns() - start;
+    CHECK(p_server->server_state.tai_seconds >= TAI_SECONDS_START + count / 2);
+
+    printf("test_clock: %u deltas exact, %.1f ns/update\n", count, (double) elapsed_ns / count);
+    return 0;
+}
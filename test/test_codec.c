@@ -0,0 +1,209 @@
+/**
+ * @file test_codec.c
+ * @brief Payload codecs of time_model_messages.h, and their cost
+ *
+ * @details Checks the bytes written by time_model_msg_encode() for each message against their layout in the
+ * specification, the fields read back by time_model_msg_decode(), and that the Time Status codec written out in
+ * time_status_msg_encode() and time_status_msg_decode() gives the same bytes and fields as the field table codec.
+ * Then times both codecs on the Time Status message.
+ *
+ * Usage: test_codec [messages]
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "test_common.h"
+#include "time_model_messages.h"
+
+#define BATCH_SIZE (1024)
+
+/* The Time Status message through the field table codec, for reference */
+static const time_model_msg_field_t m_time_status_fields[] = {
+    TIME_MODEL_MSG_FIELD(time_status_msg_pkt_t, tai_seconds, 0, 40),
+    TIME_MODEL_MSG_FIELD(time_status_msg_pkt_t, subsecond, 40, 8),
+    TIME_MODEL_MSG_FIELD(time_status_msg_pkt_t, uncertainty, 48, 8),
+    TIME_MODEL_MSG_FIELD(time_status_msg_pkt_t, time_authority, 56, 1),
+    TIME_MODEL_MSG_FIELD(time_status_msg_pkt_t, tai_utc_delta, 57, 15),
+    TIME_MODEL_MSG_FIELD(time_status_msg_pkt_t, time_zone_offset, 72, 8),
+};
+
+static const time_model_msg_format_t m_time_status_format =
+    TIME_MODEL_MSG_FORMAT(time_status_msg_pkt_t, m_time_status_fields, TIME_STATUS_MAXLEN);
+
+static uint64_t m_seed = 1;
+
+static uint64_t random_next(void) {
+    m_seed = m_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return m_seed >> 16;
+}
+
+static time_status_msg_pkt_t time_status_random(void) {
+    time_status_msg_pkt_t msg = {
+        .tai_seconds = 1 + random_next() % TAI_TIME_MAX_VAL,
+        .subsecond = (uint8_t) random_next(),
+        .uncertainty = (uint8_t) random_next(),
+        .time_authority = (uint8_t) (random_next() & 1),
+        .tai_utc_delta = (uint16_t) (random_next() & 0x7FFF),
+        .time_zone_offset = (uint8_t) random_next()
+    };
+    return msg;
+}
+
+static bool time_status_equal(const time_status_msg_pkt_t * p_a, const time_status_msg_pkt_t * p_b) {
+    return p_a->tai_seconds == p_b->tai_seconds && p_a->subsecond == p_b->subsecond &&
+           p_a->uncertainty == p_b->uncertainty && p_a->time_authority == p_b->time_authority &&
+           p_a->tai_utc_delta == p_b->tai_utc_delta && p_a->time_zone_offset == p_b->time_zone_offset;
+}
+
+static void table_codec_check(void) {
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint8_t expected[TIME_STATUS_MAXLEN];
+
+    for (uint32_t i = 0; i < 10000; i++) {
+        /* Time Set, laid out like the Time Status */
+        time_status_msg_pkt_t status = time_status_random();
+        time_set_msg_pkt_t set = {
+            .tai_seconds = status.tai_seconds,
+            .subsecond = status.subsecond,
+            .uncertainty = status.uncertainty,
+            .time_authority = status.time_authority,
+            .tai_utc_delta = status.tai_utc_delta,
+            .time_zone_offset = status.time_zone_offset
+        };
+        CHECK(time_model_msg_encode(&time_set_msg_format, &set, buffer) == TIME_SET_LEN);
+        test_time_msg_build(expected, set.tai_seconds, set.subsecond, set.uncertainty, set.time_authority,
+                            set.tai_utc_delta, set.time_zone_offset);
+        CHECK(memcmp(buffer, expected, TIME_SET_LEN) == 0);
+        time_set_msg_pkt_t set_out;
+        time_model_msg_decode(&time_set_msg_format, buffer, TIME_SET_LEN, &set_out);
+        CHECK(set_out.tai_seconds == set.tai_seconds && set_out.subsecond == set.subsecond);
+        CHECK(set_out.uncertainty == set.uncertainty && set_out.time_authority == set.time_authority);
+        CHECK(set_out.tai_utc_delta == set.tai_utc_delta && set_out.time_zone_offset == set.time_zone_offset);
+
+        /* Time Zone Set and Status */
+        uint64_t change = random_next() & TAI_TIME_MAX_VAL;
+        time_zone_set_msg_pkt_t zone_set = {
+            .time_zone_offset_new = (uint8_t) random_next(),
+            .time_zone_change = change
+        };
+        CHECK(time_model_msg_encode(&time_zone_set_msg_format, &zone_set, buffer) == TIME_ZONE_SET_LEN);
+        CHECK(buffer[0] == zone_set.time_zone_offset_new && test_get_le(&buffer[1], 5) == change);
+
+        time_zone_status_msg_pkt_t zone_status = {
+            .time_zone_offset_current = (uint8_t) random_next(),
+            .time_zone_offset_new = (uint8_t) random_next(),
+            .time_zone_change = change
+        };
+        CHECK(time_model_msg_encode(&time_zone_status_msg_format, &zone_status, buffer) == TIME_ZONE_STATUS_LEN);
+        CHECK(buffer[0] == zone_status.time_zone_offset_current && buffer[1] == zone_status.time_zone_offset_new);
+        CHECK(test_get_le(&buffer[2], 5) == change);
+        time_zone_status_msg_pkt_t zone_status_out;
+        time_model_msg_decode(&time_zone_status_msg_format, buffer, TIME_ZONE_STATUS_LEN, &zone_status_out);
+        CHECK(memcmp(&zone_status_out, &zone_status, sizeof(zone_status)) == 0);
+
+        /* TAI-UTC Delta Set and Status, each delta followed by a padding bit */
+        tai_utc_delta_status_msg_pkt_t delta_status = {
+            .tai_utc_delta_current = (uint16_t) (random_next() & 0x7FFF),
+            .tai_utc_delta_new = (uint16_t) (random_next() & 0x7FFF),
+            .tai_utc_delta_change = change
+        };
+        CHECK(time_model_msg_encode(&tai_utc_delta_status_msg_format, &delta_status, buffer) ==
+              TAI_UTC_DELTA_STATUS_LEN);
+        CHECK(test_get_le(&buffer[0], 2) == delta_status.tai_utc_delta_current);
+        CHECK(test_get_le(&buffer[2], 2) == delta_status.tai_utc_delta_new && test_get_le(&buffer[4], 5) == change);
+        buffer[1] |= 0x80;
+        buffer[3] |= 0x80;
+        tai_utc_delta_status_msg_pkt_t delta_status_out;
+        time_model_msg_decode(&tai_utc_delta_status_msg_format, buffer, TAI_UTC_DELTA_STATUS_LEN, &delta_status_out);
+        CHECK(memcmp(&delta_status_out, &delta_status, sizeof(delta_status)) == 0);
+
+        tai_utc_delta_set_msg_pkt_t delta_set = {
+            .tai_utc_delta_new = (uint16_t) random_next() | 0x8000,
+            .tai_utc_delta_change = change
+        };
+        CHECK(time_model_msg_encode(&tai_utc_delta_set_msg_format, &delta_set, buffer) == TAI_UTC_DELTA_SET_LEN);
+        CHECK(test_get_le(&buffer[0], 2) == (delta_set.tai_utc_delta_new & 0x7FFF));
+        CHECK(test_get_le(&buffer[2], 5) == change);
+    }
+
+    /* Time Role */
+    time_role_set_msg_pkt_t role = {
+        .time_role = 3
+    };
+    CHECK(time_model_msg_encode(&time_role_set_msg_format, &role, buffer) == TIME_ROLE_SET_LEN && buffer[0] == 3);
+    time_role_status_msg_pkt_t role_status;
+    time_model_msg_decode(&time_role_status_msg_format, buffer, TIME_ROLE_STATUS_LEN, &role_status);
+    CHECK(role_status.time_role == 3);
+}
+
+static void time_status_codec_check(void) {
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint8_t expected[TIME_STATUS_MAXLEN];
+    time_status_msg_pkt_t msg_out;
+    time_status_msg_pkt_t msg_ref;
+
+    for (uint32_t i = 0; i < 100000; i++) {
+        time_status_msg_pkt_t msg = time_status_random();
+
+        CHECK(time_status_msg_encode(&msg, buffer) == TIME_STATUS_MAXLEN);
+        CHECK(time_model_msg_encode(&m_time_status_format, &msg, expected) == TIME_STATUS_MAXLEN);
+        CHECK(memcmp(buffer, expected, TIME_STATUS_MAXLEN) == 0);
+
+        time_status_msg_decode(buffer, TIME_STATUS_MAXLEN, &msg_out);
+        CHECK(time_status_equal(&msg_out, &msg));
+
+        /* Random payloads, with all the bits set at random, decode like the table codec */
+        test_put_le(buffer, random_next(), 8);
+        test_put_le(&buffer[8], random_next(), 2);
+        time_status_msg_decode(buffer, TIME_STATUS_MAXLEN, &msg_out);
+        time_model_msg_decode(&m_time_status_format, buffer, TIME_STATUS_MAXLEN, &msg_ref);
+        CHECK(time_status_equal(&msg_out, &msg_ref));
+    }
+
+    /* The 5 byte form of an unknown time */
+    memset(buffer, 0xFF, sizeof(buffer));
+    test_put_le(buffer, TAI_TIME_UNKNOWN, 5);
+    time_status_msg_decode(buffer, TIME_STATUS_MINLEN, &msg_out);
+    CHECK(msg_out.tai_seconds == TAI_TIME_UNKNOWN && msg_out.subsecond == 0 && msg_out.uncertainty == 0);
+    CHECK(msg_out.time_authority == 0 && msg_out.tai_utc_delta == 0 && msg_out.time_zone_offset == 0);
+}
+
+int main(int argc, char ** argv) {
+    uint32_t count = test_count_arg(argc, argv, 10000000);
+
+    table_codec_check();
+    time_status_codec_check();
+
+    /* Cost of an encode and a decode of a Time Status, through each codec */
+    static time_status_msg_pkt_t msgs[BATCH_SIZE];
+    for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+        msgs[i] = time_status_random();
+    }
+
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    time_status_msg_pkt_t msg_out;
+    uint64_t checksum = 0;
+
+    uint64_t start = test_time_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        time_status_msg_encode(&msgs[i % BATCH_SIZE], buffer);
+        buffer[5] ^= (uint8_t) i;
+        time_status_msg_decode(buffer, TIME_STATUS_MAXLEN, &msg_out);
+        checksum += msg_out.subsecond;
+    }
+    uint64_t inline_ns = test_time_ns() - start;
+
+    start = test_time_ns();
+    for (uint32_t i = 0; i < count; i++) {
+        time_model_msg_encode(&m_time_status_format, &msgs[i % BATCH_SIZE], buffer);
+        buffer[5] ^= (uint8_t) i;
+        time_model_msg_decode(&m_time_status_format, buffer, TIME_STATUS_MAXLEN, &msg_out);
+        checksum += msg_out.subsecond;
+    }
+    uint64_t table_ns = test_time_ns() - start;
+    CHECK(checksum > 0);
+
+    printf("test_codec: Time Status encode + decode, %.1f ns written out, %.1f ns through the field table\n",
+           (double) inline_ns / count, (double) table_ns / count);
+    return 0;
+}
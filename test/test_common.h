@@ -0,0 +1,69 @@
+/**
+ * @file test_common.h
+ * @brief Helpers shared by the host tests and benchmarks
+ */
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/** Fails the test with the location of the check */
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            exit(1);                                                                      \
+        }                                                                                 \
+    } while (0)
+
+/** Monotonic time in nanoseconds, for the benchmarks */
+static inline uint64_t test_time_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+/** Iteration count given as first argument, for a short run from make check, or default_count */
+static inline uint32_t test_count_arg(int argc, char ** argv, uint32_t default_count) {
+    return argc > 1 ? (uint32_t) strtoul(argv[1], NULL, 0) : default_count;
+}
+
+static inline void test_put_le(uint8_t * p_buffer, uint64_t value, uint8_t size) {
+    for (uint8_t i = 0; i < size; i++) {
+        p_buffer[i] = (uint8_t) (value >> (8 * i));
+    }
+}
+
+static inline uint64_t test_get_le(const uint8_t * p_buffer, uint8_t size) {
+    uint64_t value = 0;
+    for (uint8_t i = 0; i < size; i++) {
+        value |= (uint64_t) p_buffer[i] << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * Builds the payload of a Time Set or Time Status message, Section 5.2.1.2, from the fields as they
+ * are sent: tai_utc_delta and time_zone_offset are the encoded values.
+ *
+ * @return Length of the payload
+ */
+static inline uint16_t test_time_msg_build(uint8_t * p_buffer, uint64_t tai_seconds, uint8_t subsecond,
+                                           uint8_t uncertainty, bool time_authority, uint16_t tai_utc_delta,
+                                           uint8_t time_zone_offset) {
+    test_put_le(&p_buffer[0], tai_seconds, 5);
+    if (tai_seconds == 0) {
+        return 5;
+    }
+    p_buffer[5] = subsecond;
+    p_buffer[6] = uncertainty;
+    test_put_le(&p_buffer[7], (uint16_t) ((time_authority ? 1 : 0) | (tai_utc_delta << 1)), 2);
+    p_buffer[9] = time_zone_offset;
+    return 10;
+}
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file test_instances.c
+ * @brief Several Time Setup Server instances in one image, built with the app timer
+ *
+ * @details Checks that each instance calls its own callbacks, and that the instances share the app timer while
+ * each keeps the 1 second ticks of its own time, in the phase it was set at.
+ */
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_messages.h"
+#include "time_model_setup_server.h"
+
+#define NODE_ADDRESS (0x0001)
+#define PEER_ADDRESS (0x0002)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+#define US_PER_SEC (1000000ULL)
+
+static time_setup_server_t m_servers[2] = {TIME_SETUP_SERVER_DEFAULT_SETTINGS, TIME_SETUP_SERVER_DEFAULT_SETTINGS};
+static uint32_t m_time_get_counts[2];
+
+static void time_get_cb(time_server_t * p_self, const access_message_rx_meta_t * p_meta) {
+    CHECK(p_self == &m_servers[0].time_server || p_self == &m_servers[1].time_server);
+    m_time_get_counts[p_self == &m_servers[1].time_server]++;
+}
+
+static uint64_t tai_seconds_get(uint32_t index) {
+    uint64_t tai_seconds;
+    uint8_t subsecond;
+    CHECK(time_server_state_get_time(&m_servers[index].time_server, &tai_seconds, &subsecond) == NRF_SUCCESS);
+    return tai_seconds;
+}
+
+int main(void) {
+    const time_server_callbacks_t callbacks = {
+        .time_get_cb = time_get_cb
+    };
+
+    mesh_stub_node_set(NODE_ADDRESS);
+    for (uint32_t i = 0; i < 2; i++) {
+        CHECK(time_setup_server_init(&m_servers[i], (uint8_t) i) == NRF_SUCCESS);
+    }
+    CHECK(time_server_set_callbacks(NULL, &callbacks) == NRF_ERROR_NULL);
+    CHECK(time_server_set_callbacks(&m_servers[1].time_server, NULL) == NRF_ERROR_NULL);
+    CHECK(time_server_set_callbacks(&m_servers[1].time_server, &callbacks) == NRF_SUCCESS);
+
+    /* Only the instance with callbacks calls them */
+    CHECK(mesh_stub_rx(m_servers[0].time_server.model_handle, TIME_OPCODE_GET, NULL, 0, PEER_ADDRESS, 0) ==
+          NRF_SUCCESS);
+    CHECK(m_time_get_counts[0] == 0 && m_time_get_counts[1] == 0);
+    CHECK(mesh_stub_rx(m_servers[1].time_server.model_handle, TIME_OPCODE_GET, NULL, 0, PEER_ADDRESS, 0) ==
+          NRF_SUCCESS);
+    CHECK(m_time_get_counts[0] == 0 && m_time_get_counts[1] == 1);
+
+    CHECK(time_server_set_callbacks(&m_servers[0].time_server, &callbacks) == NRF_SUCCESS);
+    CHECK(mesh_stub_rx(m_servers[0].time_server.model_handle, TIME_OPCODE_GET, NULL, 0, PEER_ADDRESS, 0) ==
+          NRF_SUCCESS);
+    CHECK(m_time_get_counts[0] == 1 && m_time_get_counts[1] == 1);
+
+    /* The second instance is set half a second after the first, and ticks half a second after it */
+    uint64_t start_us = mesh_stub_time_get();
+    time_set_params_t time = {
+        .tai_seconds = TAI_SECONDS_START,
+        .uncertainty = 10,
+        .tai_utc_delta = 37
+    };
+    CHECK(time_server_state_set_time(&m_servers[0].time_server, &time) == NRF_SUCCESS);
+    mesh_stub_run(start_us + US_PER_SEC / 2);
+    CHECK(time_server_state_set_time(&m_servers[1].time_server, &time) == NRF_SUCCESS);
+
+    mesh_stub_run(start_us + 10 * US_PER_SEC + US_PER_SEC / 4);
+    CHECK(tai_seconds_get(0) == TAI_SECONDS_START + 10 && tai_seconds_get(1) == TAI_SECONDS_START + 9);
+    mesh_stub_run(start_us + 10 * US_PER_SEC + 3 * US_PER_SEC / 4);
+    CHECK(tai_seconds_get(0) == TAI_SECONDS_START + 10 && tai_seconds_get(1) == TAI_SECONDS_START + 10);
+
+    /* An hour later, neither has lost a tick to the other */
+    mesh_stub_run(start_us + 3610 * US_PER_SEC + US_PER_SEC / 4);
+    CHECK(tai_seconds_get(0) == TAI_SECONDS_START + 3610 && tai_seconds_get(1) == TAI_SECONDS_START + 3609);
+
+    printf("test_instances: passed\n");
+    return 0;
+}
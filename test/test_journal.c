@@ -0,0 +1,227 @@
+/**
+ * @file test_journal.c
+ * @brief Journal of the Time Server state, on a flash backend in RAM, built with TIME_MODEL_PERSISTENCE and
+ * TIME_MODEL_WARM_START
+ *
+ * @details The backend behaves like NOR flash: erasing sets a page to 0xFF, and writes can only clear bits.
+ * Checks the byte layout of the records, the rotation over the pages, the fallback over torn records, and the
+ * state restored by time_setup_server_init(), with a warm start from a retained counter.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_journal.h"
+#include "time_model_messages.h"
+#include "time_model_setup_server.h"
+
+#define NODE_ADDRESS (0x0001)
+
+#define PAGE_SIZE (256)
+#define PAGE_COUNT (4)
+#define RECORD_SIZE (sizeof(time_model_journal_record_t))
+#define SLOTS_PER_PAGE ((PAGE_SIZE - 8) / RECORD_SIZE)
+
+static uint8_t m_flash[PAGE_SIZE * PAGE_COUNT];
+static uint32_t m_erase_count[PAGE_COUNT];
+
+/** Number of bytes the next write stops after, as if the device was reset while writing, or 0 */
+static uint32_t m_write_limit;
+
+/** Counter running through resets, at TIME_MODEL_RETAINED_COUNTER_FREQ */
+static uint32_t m_retained_counter;
+
+static uint32_t retained_counter_get(void) {
+    return m_retained_counter;
+}
+
+static uint32_t flash_read(void * p_context, uint32_t offset, void * p_data, uint32_t length) {
+    CHECK(offset + length <= sizeof(m_flash));
+    memcpy(p_data, &m_flash[offset], length);
+    return NRF_SUCCESS;
+}
+
+static uint32_t flash_write(void * p_context, uint32_t offset, const void * p_data, uint32_t length) {
+    CHECK(offset % 4 == 0 && length % 4 == 0 && offset + length <= sizeof(m_flash));
+    if (m_write_limit > 0 && m_write_limit < length) {
+        length = m_write_limit;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        m_flash[offset + i] &= ((const uint8_t *) p_data)[i];
+    }
+    return NRF_SUCCESS;
+}
+
+static uint32_t flash_erase_page(void * p_context, uint32_t page) {
+    CHECK(page < PAGE_COUNT);
+    memset(&m_flash[page * PAGE_SIZE], 0xFF, PAGE_SIZE);
+    m_erase_count[page]++;
+    return NRF_SUCCESS;
+}
+
+static const time_model_flash_t m_flash_backend = {
+    .read = flash_read,
+    .write = flash_write,
+    .erase_page = flash_erase_page,
+    .page_size = PAGE_SIZE,
+    .page_count = PAGE_COUNT
+};
+
+static time_model_saved_state_t state_make(uint32_t i) {
+    time_model_saved_state_t state = {
+        .tai_seconds = 0xA123456789ULL + i,
+        .subsecond = 0x12,
+        .uncertainty = 0x34,
+        .time_role = 2,
+        .time_zone_change = 0xB234567890ULL,
+        .time_zone_offset_current = 0x56,
+        .time_zone_offset_new = 0x78,
+        .tai_utc_delta_change = 0xC345678901ULL,
+        .tai_utc_delta_current = 0x7ABC,
+        .tai_utc_delta_new = 0x7DEF,
+        .subsecond_fraction = 0x9876,
+        .anchor_tick = 0xFEDCBA98 - i,
+        .last_sync_tai_seconds = 0xD456789012ULL
+    };
+    return state;
+}
+
+static void state_check(const time_model_journal_t * p_journal, uint32_t i) {
+    time_model_saved_state_t expected = state_make(i);
+    time_model_saved_state_t state;
+
+    CHECK(time_model_journal_read(p_journal, &state) == NRF_SUCCESS);
+    CHECK(state.tai_seconds == expected.tai_seconds && state.subsecond == expected.subsecond);
+    CHECK(state.uncertainty == expected.uncertainty && state.time_role == expected.time_role);
+    CHECK(state.time_zone_change == expected.time_zone_change);
+    CHECK(state.time_zone_offset_current == expected.time_zone_offset_current);
+    CHECK(state.time_zone_offset_new == expected.time_zone_offset_new);
+    CHECK(state.tai_utc_delta_change == expected.tai_utc_delta_change);
+    CHECK(state.tai_utc_delta_current == expected.tai_utc_delta_current);
+    CHECK(state.tai_utc_delta_new == expected.tai_utc_delta_new);
+    CHECK(state.subsecond_fraction == expected.subsecond_fraction && state.anchor_tick == expected.anchor_tick);
+    CHECK(state.last_sync_tai_seconds == expected.last_sync_tai_seconds);
+}
+
+static void journal_test(void) {
+    time_model_journal_t journal;
+    time_model_saved_state_t state;
+
+    memset(m_flash, 0xFF, sizeof(m_flash));
+    CHECK(time_model_journal_open(&journal, &m_flash_backend) == NRF_SUCCESS);
+    CHECK(time_model_journal_read(&journal, &state) == NRF_ERROR_NOT_FOUND);
+
+    /* The state is stored at fixed little-endian offsets, after the page header and the record header */
+    state = state_make(0);
+    CHECK(time_model_journal_write(&journal, &state) == NRF_SUCCESS);
+    const uint8_t * p_state = &m_flash[8 + 8];
+    CHECK(test_get_le(&p_state[0], 5) == 0xA123456789ULL && p_state[5] == 0x12 && p_state[6] == 0x34);
+    CHECK(p_state[7] == 2 && test_get_le(&p_state[8], 5) == 0xB234567890ULL);
+    CHECK(p_state[13] == 0x56 && p_state[14] == 0x78 && test_get_le(&p_state[15], 5) == 0xC345678901ULL);
+    CHECK(test_get_le(&p_state[20], 2) == 0x7ABC && test_get_le(&p_state[22], 2) == 0x7DEF);
+    CHECK(test_get_le(&p_state[24], 2) == 0x9876 && test_get_le(&p_state[26], 4) == 0xFEDCBA98);
+    CHECK(test_get_le(&p_state[30], 5) == 0xD456789012ULL && p_state[35] == 0);
+    state_check(&journal, 0);
+
+    /* Many records rotate over the pages, erasing each of them in turn, and the last one is found on open */
+    uint32_t count = 10 * PAGE_COUNT * SLOTS_PER_PAGE + 3;
+    for (uint32_t i = 1; i < count; i++) {
+        state = state_make(i);
+        CHECK(time_model_journal_write(&journal, &state) == NRF_SUCCESS);
+    }
+    state_check(&journal, count - 1);
+    for (uint16_t page = 1; page < PAGE_COUNT; page++) {
+        CHECK(m_erase_count[page] == m_erase_count[0] || m_erase_count[page] == m_erase_count[0] - 1);
+    }
+
+    CHECK(time_model_journal_open(&journal, &m_flash_backend) == NRF_SUCCESS);
+    state_check(&journal, count - 1);
+
+    /* A record torn by a reset fails its CRC, and the previous one is restored */
+    m_write_limit = 12;
+    state = state_make(count);
+    CHECK(time_model_journal_write(&journal, &state) == NRF_SUCCESS);
+    m_write_limit = 0;
+    CHECK(time_model_journal_open(&journal, &m_flash_backend) == NRF_SUCCESS);
+    state_check(&journal, count - 1);
+
+    /* ...and the next record goes after the torn one */
+    state = state_make(count + 1);
+    CHECK(time_model_journal_write(&journal, &state) == NRF_SUCCESS);
+    CHECK(time_model_journal_open(&journal, &m_flash_backend) == NRF_SUCCESS);
+    state_check(&journal, count + 1);
+
+    /* A reset right after moving on to a new page finds the last record on the previous one */
+    do {
+        state = state_make(count + 2);
+        CHECK(time_model_journal_write(&journal, &state) == NRF_SUCCESS);
+    } while (journal.next_slot < SLOTS_PER_PAGE);
+    uint16_t next_page = (journal.page + 1) % PAGE_COUNT;
+    uint32_t header[2] = {0x544D4A31, journal.page_seq + 1};
+    flash_erase_page(NULL, next_page);
+    flash_write(NULL, next_page * PAGE_SIZE, header, sizeof(header));
+    CHECK(time_model_journal_open(&journal, &m_flash_backend) == NRF_SUCCESS);
+    CHECK(journal.page == next_page);
+    state_check(&journal, count + 2);
+}
+
+static void server_test(void) {
+    static time_model_journal_t journal;
+    static time_setup_server_t server = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+    static time_setup_server_t restarted = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+
+    memset(m_flash, 0xFF, sizeof(m_flash));
+    CHECK(time_model_journal_open(&journal, &m_flash_backend) == NRF_SUCCESS);
+    server.time_server.p_journal = &journal;
+    server.time_server.retained_counter_get = retained_counter_get;
+    CHECK(time_setup_server_init(&server, 0) == NRF_SUCCESS);
+
+    time_set_params_t time = {
+        .tai_seconds = 700000000,
+        .uncertainty = 10,
+        .tai_utc_delta = 37
+    };
+    CHECK(time_server_state_set_time(&server.time_server, &time) == NRF_SUCCESS);
+
+    time_zone_set_params_t zone = {
+        .time_zone_offset_new = -20,
+        .time_zone_change = 800000000
+    };
+    CHECK(time_server_state_set_time_zone_offset(&server.time_server, &zone) == NRF_SUCCESS);
+    time_role_set_params_t role = {
+        .time_role = TIME_ROLE_RELAY
+    };
+    CHECK(time_setup_server_state_set_time_role(&server, &role) == NRF_SUCCESS);
+
+    /* A restart 100 s later restores the role and the scheduled Time Zone Offset change, and the time from the
+       retained counter, with the drift over the 100 s and the second the saved time can lag by added to the
+       uncertainty. The last sync keeps its age */
+    m_retained_counter += 100 * TIME_MODEL_RETAINED_COUNTER_FREQ;
+    CHECK(time_model_journal_open(&journal, &m_flash_backend) == NRF_SUCCESS);
+    mesh_stub_reset();
+    mesh_stub_node_set(NODE_ADDRESS);
+    restarted.time_server.p_journal = &journal;
+    restarted.time_server.retained_counter_get = retained_counter_get;
+    CHECK(time_setup_server_init(&restarted, 0) == NRF_SUCCESS);
+    CHECK(restarted.time_server.server_state.time_role == TIME_ROLE_RELAY);
+    CHECK(restarted.time_server.server_state.time_zone_offset_new == -20);
+    CHECK(restarted.time_server.server_state.time_zone_change == 800000000);
+
+    uint64_t tai_seconds;
+    uint8_t subsecond;
+    CHECK(time_server_state_get_time(&restarted.time_server, &tai_seconds, &subsecond) == NRF_SUCCESS);
+    CHECK(tai_seconds == 700000100 && subsecond == 0);
+    CHECK(restarted.time_server.server_state.uncertainty == 10 + 1 + 100);
+    CHECK(restarted.time_server.last_sync_time >> 24 == 700000000);
+}
+
+int main(void) {
+    mesh_stub_node_set(NODE_ADDRESS);
+
+    journal_test();
+    server_test();
+
+    printf("test_journal: passed\n");
+    return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file test_snapshot.c
+ * @brief Snapshots of the time state, built with TIME_MODEL_STATE_SNAPSHOT
+ *
+ * @details A thread takes snapshots while the main thread keeps setting the time to values whose TAI seconds
+ * and subsecond go together, and checks that no snapshot mixes two of them and that the time never goes back.
+ *
+ * Usage: test_snapshot [updates]
+ */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_setup_server.h"
+
+#define NODE_ADDRESS (0x0001)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+static time_setup_server_t m_server = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+
+static volatile bool m_done;
+static uint32_t m_snapshot_count;
+
+static void * reader_thread(void * p_arg) {
+    uint64_t previous_tai_seconds = 0;
+    time_server_state_t state;
+
+    while (!__atomic_load_n(&m_done, __ATOMIC_ACQUIRE)) {
+        CHECK(time_server_state_snapshot(&m_server.time_server, &state) == NRF_SUCCESS);
+        if (state.tai_seconds == TAI_TIME_UNKNOWN) {
+            continue;
+        }
+        CHECK(state.subsecond == (uint8_t) (state.tai_seconds - TAI_SECONDS_START));
+        CHECK(state.tai_seconds >= previous_tai_seconds);
+        previous_tai_seconds = state.tai_seconds;
+        m_snapshot_count++;
+    }
+    return NULL;
+}
+
+int main(int argc, char ** argv) {
+    uint32_t count = test_count_arg(argc, argv, 1000000);
+    time_server_state_t state;
+    pthread_t reader;
+
+    mesh_stub_node_set(NODE_ADDRESS);
+    CHECK(time_setup_server_init(&m_server, 0) == NRF_SUCCESS);
+    CHECK(time_server_state_snapshot(&m_server.time_server, NULL) == NRF_ERROR_NULL);
+    CHECK(time_server_state_snapshot(&m_server.time_server, &state) == NRF_SUCCESS);
+    CHECK(state.tai_seconds == TAI_TIME_UNKNOWN);
+
+    CHECK(pthread_create(&reader, NULL, reader_thread, NULL) == 0);
+    for (uint32_t i = 1; i <= count; i++) {
+        time_state_update_time(&m_server.time_server, TAI_SECONDS_START + i, (uint8_t) i);
+    }
+    __atomic_store_n(&m_done, true, __ATOMIC_RELEASE);
+    CHECK(pthread_join(reader, NULL) == 0);
+
+    CHECK(time_server_state_snapshot(&m_server.time_server, &state) == NRF_SUCCESS);
+    CHECK(state.tai_seconds == TAI_SECONDS_START + count && state.subsecond == (uint8_t) count);
+
+    printf("test_snapshot: %u updates, %u snapshots checked\n", count, m_snapshot_count);
+    return 0;
+}
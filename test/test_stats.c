@@ -0,0 +1,87 @@
+/**
+ * @file test_stats.c
+ * @brief Counters of time_model_stats.h, built with TIME_MODEL_STATS
+ *
+ * @details Checks the messages counted per opcode as they are received and sent, the error codes of the failed
+ * sends, the relayed Time Status messages, and that each handler run lands in one bucket of the histogram while
+ * the messages dropped for their length are only counted as invalid.
+ */
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_messages.h"
+#include "time_model_setup_server.h"
+#include "time_model_stats.h"
+
+#define NODE_ADDRESS (0x0001)
+#define PEER_ADDRESS (0x0002)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+static time_setup_server_t m_server = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+
+static uint32_t histogram_sum(const time_model_opcode_stats_t * p_opcode) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < TIME_MODEL_STATS_LATENCY_BUCKETS; i++) {
+        sum += p_opcode->latency_histogram[i];
+    }
+    return sum;
+}
+
+int main(void) {
+    time_server_t * p_server = &m_server.time_server;
+    time_model_stats_t stats;
+
+    mesh_stub_node_set(NODE_ADDRESS);
+    CHECK(time_setup_server_init(&m_server, 0) == NRF_SUCCESS);
+    time_model_stats_reset();
+
+    /* A Time Get is counted as received, and its Time Status as sent */
+    CHECK(mesh_stub_rx(p_server->model_handle, TIME_OPCODE_GET, NULL, 0, PEER_ADDRESS, 0) == NRF_SUCCESS);
+    CHECK(mesh_stub_rx(m_server.model_handle, TIME_OPCODE_ROLE_GET, NULL, 0, PEER_ADDRESS, 0) == NRF_SUCCESS);
+    time_model_stats_snapshot(&stats);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_GET].rx_count == 1);
+    CHECK(histogram_sum(&stats.opcodes[TIME_MODEL_STATS_OPCODE_GET]) == 1);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_STATUS].tx_count == 1);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_ROLE_GET].rx_count == 1);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_ROLE_STATUS].tx_count == 1);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_STATUS].rx_count == 0);
+
+    /* A message of the wrong length is dropped before its handler, and only counted as such */
+    uint8_t byte = 0;
+    CHECK(mesh_stub_rx(p_server->model_handle, TIME_OPCODE_GET, &byte, 1, PEER_ADDRESS, 0) == NRF_SUCCESS);
+    time_model_stats_snapshot(&stats);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_GET].rx_invalid_count == 1);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_GET].rx_count == 1);
+    CHECK(histogram_sum(&stats.opcodes[TIME_MODEL_STATS_OPCODE_GET]) == 1);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_STATUS].tx_count == 1);
+
+    /* A send the access layer refuses is counted with its error code */
+    mesh_stub_publish_status_set(NRF_ERROR_INVALID_STATE);
+    CHECK(mesh_stub_rx(p_server->model_handle, TIME_OPCODE_ZONE_GET, NULL, 0, PEER_ADDRESS, 0) == NRF_SUCCESS);
+    mesh_stub_publish_status_set(NRF_SUCCESS);
+    time_model_stats_snapshot(&stats);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_ZONE_STATUS].tx_count == 0);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_ZONE_STATUS].tx_error_count == 1);
+    CHECK(stats.error_counts[NRF_ERROR_INVALID_STATE - NRF_ERROR_BASE_NUM] == 1);
+
+    /* A TIME RELAY counts the Time Status messages it passes on */
+    time_role_set_params_t role = {
+        .time_role = TIME_ROLE_RELAY
+    };
+    CHECK(time_setup_server_state_set_time_role(&m_server, &role) == NRF_SUCCESS);
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint16_t length = test_time_msg_build(buffer, TAI_SECONDS_START, 0, 0, true, 37 + 0xFF, 0x40);
+    CHECK(mesh_stub_rx(p_server->model_handle, TIME_OPCODE_STATUS, buffer, length, PEER_ADDRESS, 0) == NRF_SUCCESS);
+    time_model_stats_snapshot(&stats);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_STATUS].rx_count == 1 && stats.relay_count == 1);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_STATUS].tx_count == 2);
+
+    time_model_stats_reset();
+    time_model_stats_snapshot(&stats);
+    CHECK(stats.opcodes[TIME_MODEL_STATS_OPCODE_GET].rx_count == 0 && stats.relay_count == 0);
+
+    printf("test_stats: passed\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file test_tickless.c
+ * @brief Tickless app timer timekeeping of the Time Server, built with TIME_MODEL_TICKLESS
+ *
+ * @details The app timer of the stand-in runs from a 32768 Hz counter which wraps every 512 s like the RTC,
+ * and is only moved on with mesh_stub_run().
+ */
+#include <stdio.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_setup_server.h"
+
+#define NODE_ADDRESS (0x0001)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+#define US_PER_SEC (1000000ULL)
+
+static time_setup_server_t m_server = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+
+static void time_check(uint64_t tai_seconds, uint8_t subsecond) {
+    uint64_t read_tai_seconds;
+    uint8_t read_subsecond;
+
+    CHECK(time_server_state_get_time(&m_server.time_server, &read_tai_seconds, &read_subsecond) == NRF_SUCCESS);
+    CHECK(read_tai_seconds == tai_seconds && read_subsecond == subsecond);
+}
+
+int main(void) {
+    time_server_t * p_server = &m_server.time_server;
+
+    mesh_stub_node_set(NODE_ADDRESS);
+    CHECK(time_setup_server_init(&m_server, 0) == NRF_SUCCESS);
+
+    /* A time which was never set stays unknown across the wakeups of the timer */
+    mesh_stub_run(3600 * US_PER_SEC);
+    time_check(TAI_TIME_UNKNOWN, 0);
+
+    /* The time counts from where it was set, exactly over hours and wraps of the RTC counter */
+    time_set_params_t time = {
+        .tai_seconds = TAI_SECONDS_START,
+        .subsecond = 0,
+        .tai_utc_delta = 37,
+        .time_zone_offset = 0
+    };
+    uint64_t start_us = mesh_stub_time_get();
+    CHECK(time_server_state_set_time(p_server, &time) == NRF_SUCCESS);
+
+    mesh_stub_run(start_us + 1000 * US_PER_SEC + US_PER_SEC / 2);
+    time_check(TAI_SECONDS_START + 1000, 128);
+
+    for (uint32_t hour = 1; hour <= 10; hour++) {
+        mesh_stub_run(start_us + hour * 3600 * US_PER_SEC + US_PER_SEC / 4);
+        time_check(TAI_SECONDS_START + hour * 3600, 64);
+    }
+
+    /* Reading the time often does not drift it either */
+    uint64_t now_us = mesh_stub_time_get();
+    for (uint32_t i = 1; i <= 100000; i++) {
+        mesh_stub_run(now_us + i * 7777);
+        uint64_t tai_seconds;
+        uint8_t subsecond;
+        CHECK(time_server_state_get_time(p_server, &tai_seconds, &subsecond) == NRF_SUCCESS);
+    }
+    mesh_stub_run(start_us + 11 * 3600 * US_PER_SEC + US_PER_SEC / 4);
+    time_check(TAI_SECONDS_START + 11 * 3600, 64);
+
+    /* The timer wakes up at a pending Time Zone change, without the time being read */
+    time_zone_set_params_t zone = {
+        .time_zone_offset_new = 8,
+        .time_zone_change = TAI_SECONDS_START + 11 * 3600 + 100
+    };
+    CHECK(time_server_state_set_time_zone_offset(p_server, &zone) == NRF_SUCCESS);
+
+    mesh_stub_run(start_us + (11 * 3600 + 99) * US_PER_SEC);
+    CHECK(p_server->server_state.time_zone_offset_current == 0);
+    mesh_stub_run(start_us + (11 * 3600 + 100) * US_PER_SEC + US_PER_SEC / 100);
+    CHECK(p_server->server_state.time_zone_offset_current == 8);
+
+    /* A TAI-UTC Delta change further than the longest sleep away */
+    tai_utc_delta_set_params_t delta = {
+        .tai_utc_delta_new = 38,
+        .tai_utc_delta_change = TAI_SECONDS_START + 12 * 3600
+    };
+    CHECK(time_server_state_set_tai_utc_delta(p_server, &delta) == NRF_SUCCESS);
+
+    mesh_stub_run(start_us + 12 * 3600 * US_PER_SEC - US_PER_SEC);
+    CHECK(p_server->server_state.tai_utc_delta_current == 37);
+    mesh_stub_run(start_us + 12 * 3600 * US_PER_SEC + US_PER_SEC / 100);
+    CHECK(p_server->server_state.tai_utc_delta_current == 38);
+
+    printf("test_tickless: passed\n");
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file test_trace.c
+ * @brief Trace of the Time Server events, built with TIME_MODEL_TRACE and the 1 second ticks of the app timer
+ *
+ * @details Checks that the ticks on time leave the ring to the events it exists to keep, that a tick handled too
+ * late for the next one is recorded, and the record of a Time Set message.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "mesh_stub.h"
+#include "test_common.h"
+#include "time_model_messages.h"
+#include "time_model_setup_server.h"
+#include "time_model_trace.h"
+
+#define NODE_ADDRESS (0x0001)
+#define PEER_ADDRESS (0x0002)
+
+#define TAI_SECONDS_START (700000000ULL)
+
+#define US_PER_SEC (1000000ULL)
+
+static time_setup_server_t m_server = TIME_SETUP_SERVER_DEFAULT_SETTINGS;
+
+static time_model_trace_record_t m_records[TIME_MODEL_TRACE_SIZE];
+
+static uint32_t drain(void) {
+    uint32_t lost;
+    uint32_t count = time_model_trace_drain(m_records, TIME_MODEL_TRACE_SIZE, &lost);
+    CHECK(lost == 0);
+    return count;
+}
+
+int main(void) {
+    time_server_t * p_server = &m_server.time_server;
+
+    mesh_stub_node_set(NODE_ADDRESS);
+    CHECK(time_setup_server_init(&m_server, 0) == NRF_SUCCESS);
+
+    time_set_params_t time = {
+        .tai_seconds = TAI_SECONDS_START,
+        .uncertainty = 10,
+        .tai_utc_delta = 37
+    };
+    CHECK(time_server_state_set_time(p_server, &time) == NRF_SUCCESS);
+    drain();
+
+    /* Ten minutes of ticks on time record nothing */
+    mesh_stub_run(mesh_stub_time_get() + 600 * US_PER_SEC);
+    CHECK(drain() == 0);
+
+    /* A tick handled 3 s late is recorded */
+    uint64_t tai_seconds;
+    uint8_t subsecond;
+    CHECK(time_server_state_get_time(p_server, &tai_seconds, &subsecond) == NRF_SUCCESS);
+    mesh_stub_time_set(mesh_stub_time_get() + 3 * US_PER_SEC);
+    mesh_stub_run(mesh_stub_time_get());
+    CHECK(drain() == 1);
+    CHECK(m_records[0].event == TIME_MODEL_TRACE_TIMER && m_records[0].src == TIME_MODEL_TRACE_SRC_LOCAL);
+    CHECK(m_records[0].old_value == (uint32_t) tai_seconds && m_records[0].new_value == (uint32_t) tai_seconds + 1);
+
+    /* A Time Set message */
+    uint8_t buffer[TIME_STATUS_MAXLEN];
+    uint16_t length = test_time_msg_build(buffer, TAI_SECONDS_START + 5000, 0, 20, false, 37 + 0xFF, 0x40);
+    CHECK(mesh_stub_rx(m_server.model_handle, TIME_OPCODE_SET, buffer, length, PEER_ADDRESS, 0) == NRF_SUCCESS);
+    CHECK(drain() == 1);
+    CHECK(m_records[0].event == TIME_MODEL_TRACE_TIME_SET && m_records[0].src == PEER_ADDRESS);
+    CHECK(m_records[0].new_value == (uint32_t) (TAI_SECONDS_START + 5000) && m_records[0].detail == 20);
+
+    char text[128];
+    CHECK(time_model_trace_record_format(&m_records[0], text, sizeof(text)) > 0);
+    CHECK(strstr(text, time_model_trace_event_name(TIME_MODEL_TRACE_TIME_SET)) != NULL);
+
+    printf("test_trace: passed\n");
+    return 0;
+}